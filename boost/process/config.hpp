@@ -21,6 +21,16 @@
 #   include <winsock2.h>
 #endif
 
+// The posix executor's core, see posix/impl/executor.ipp, is inline in every translation
+// unit by default. With BOOST_PROCESS_SEPARATE_COMPILATION defined for the whole program
+// it is compiled once, in libs/process/src/executor.cpp, which the program then links.
+#if defined(BOOST_PROCESS_SEPARATE_COMPILATION)
+#   define BOOST_PROCESS_DECL
+#else
+#   define BOOST_PROCESS_HEADER_ONLY
+#   define BOOST_PROCESS_DECL inline
+#endif
+
 #define BOOST_PROCESS_PLATFORM_PROMOTE_PATH(COMPONENT)             <boost/process/BOOST_PROCESS_PLATFORM/COMPONENT.hpp>
 #define BOOST_PROCESS_PLATFORM_PROMOTE_INITIALIZER_PATH(COMPONENT) <boost/process/BOOST_PROCESS_PLATFORM/initializers/COMPONENT.hpp>
 #define BOOST_PROCESS_PLATFORM_PROMOTE_NAMESPACE(COMPONENT)        namespace boost { namespace process { using BOOST_PROCESS_PLATFORM::COMPONENT; }}
@@ -0,0 +1,210 @@
+
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_DETAIL_FLAT_MAP_HPP
+#define BOOST_PROCESS_DETAIL_FLAT_MAP_HPP
+
+#include <boost/iterator/iterator_adaptor.hpp>
+#include <boost/type_traits/is_convertible.hpp>
+#include <boost/utility/enable_if.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace boost { namespace process { namespace detail {
+
+    /// Sorted associative container with contiguous storage.
+    ///
+    /// It provides the part of the std::map interface used by the environment initializers.
+    /// The entries live in one vector in insertion order and a second vector of 32 bit
+    /// indices keeps them sorted, so an insertion in the middle only moves indices instead
+    /// of strings, and appending in sorted order is O(1). Lookups are binary searches and
+    /// iteration is a linear walk over the indices. std::string keeps short names and
+    /// values inline in the entries.
+    ///
+    /// Unlike std::map, inserting or erasing invalidates iterators.
+    template<typename Key, typename T, typename Compare = std::less<Key> >
+    class flat_map
+    {
+    public:
+        typedef Key                                   key_type;
+        typedef T                                  mapped_type;
+        typedef std::pair<Key, T>                   value_type;
+        typedef Compare                            key_compare;
+        typedef std::size_t                          size_type;
+
+    private:
+        typedef std::vector<value_type>           storage_type;
+        typedef unsigned int                        index_type;
+        typedef std::vector<index_type>             order_type;
+
+        template<typename Value, typename Storage> class iter
+        : public boost::iterator_adaptor<iter<Value, Storage>, typename order_type::const_iterator, Value, boost::random_access_traversal_tag>
+        {
+            typedef boost::iterator_adaptor<iter<Value, Storage>, typename order_type::const_iterator, Value, boost::random_access_traversal_tag> base_type;
+
+        public:
+            iter() : base_type(), m_storage(0) {}
+            iter(typename order_type::const_iterator it, Storage* s) : base_type(it), m_storage(s) {}
+
+            template<typename V, typename S> iter(const iter<V, S>& other, typename boost::enable_if<boost::is_convertible<V*, Value*> >::type* = 0)
+            : base_type(other.base()), m_storage(other.m_storage) {}
+
+        private:
+            friend class boost::iterator_core_access;
+            template<typename, typename> friend class iter;
+
+            Value& dereference() const { return (*m_storage)[*this->base()]; }
+
+            Storage* m_storage;
+        };
+
+    public:
+        typedef iter<      value_type,       storage_type>       iterator;
+        typedef iter<const value_type, const storage_type> const_iterator;
+
+        struct value_compare
+        {
+            key_compare m_comp;
+
+            value_compare(const key_compare& c) : m_comp(c) {}
+
+            bool operator()(const value_type& l, const value_type& r) const { return m_comp(l.first, r.first); }
+        };
+
+        flat_map() : m_storage(), m_order(), m_comp() {}
+
+        iterator       begin()       { return       iterator(m_order.begin(), &m_storage); }
+        iterator       end  ()       { return       iterator(m_order.end  (), &m_storage); }
+        const_iterator begin() const { return const_iterator(m_order.begin(), &m_storage); }
+        const_iterator end  () const { return const_iterator(m_order.end  (), &m_storage); }
+
+        size_type size () const { return m_order.size (); }
+        bool      empty() const { return m_order.empty(); }
+        void      clear()       { m_storage.clear(); m_order.clear(); }
+
+        void reserve(size_type n) { m_storage.reserve(n); m_order.reserve(n); }
+
+        key_compare     key_comp() const { return m_comp; }
+        value_compare value_comp() const { return value_compare(m_comp); }
+
+        iterator       lower_bound(const key_type& k)       { return       iterator(m_order.begin() + position(k), &m_storage); }
+        const_iterator lower_bound(const key_type& k) const { return const_iterator(m_order.begin() + position(k), &m_storage); }
+
+        iterator find(const key_type& k)
+        {
+            iterator it = lower_bound(k);
+            return (it != end() && !m_comp(k, it->first))? it : end();
+        }
+        const_iterator find(const key_type& k) const
+        {
+            const_iterator it = lower_bound(k);
+            return (it != end() && !m_comp(k, it->first))? it : end();
+        }
+
+        size_type count(const key_type& k) const { return (find(k) != end())? 1 : 0; }
+
+        std::pair<iterator, bool> insert(const value_type& v)
+        {
+            size_type pos = position(v.first);
+            if (pos != m_order.size() && !m_comp(v.first, m_storage[m_order[pos]].first))
+            {
+                return std::make_pair(iterator(m_order.begin() + pos, &m_storage), false);
+            }
+            return std::make_pair(insert_at(pos, v), true);
+        }
+
+        /// Inserts at hint if that keeps the order, so appending in sorted order is O(1).
+        iterator insert(iterator hint, const value_type& v)
+        {
+            if ((hint == begin() || m_comp((hint - 1)->first, v.first)) && (hint == end() || m_comp(v.first, hint->first)))
+            {
+                return insert_at(hint.base() - m_order.begin(), v);
+            }
+            return insert(v).first;
+        }
+
+        /// As with std::map, existing keys and the first of several equal keys in the range win.
+        template<typename InputIterator> void insert(InputIterator first, InputIterator last)
+        {
+            for (; first != last; ++first) insert(*first);
+        }
+
+        mapped_type& operator[](const key_type& k)
+        {
+            size_type pos = position(k);
+            if (pos == m_order.size() || m_comp(k, m_storage[m_order[pos]].first))
+            {
+                return insert_at(pos, value_type(k, mapped_type()))->second;
+            }
+            return m_storage[m_order[pos]].second;
+        }
+
+        iterator erase(iterator it)
+        {
+            size_type  pos = it.base() - m_order.begin();
+            index_type idx = m_order[pos];
+
+            m_order.erase(m_order.begin() + pos);
+
+            // keep the storage dense: move the last entry into the hole and repoint its index
+            index_type last = index_type(m_storage.size() - 1);
+            if (idx != last)
+            {
+                m_storage[idx] = m_storage[last];
+                m_order[position(m_storage[idx].first)] = idx;
+            }
+            m_storage.pop_back();
+
+            return iterator(m_order.begin() + pos, &m_storage);
+        }
+
+        size_type erase(const key_type& k)
+        {
+            iterator it = find(k);
+            if (it == end()) return 0;
+
+            erase(it);
+            return 1;
+        }
+
+        bool operator==(const flat_map& rhs) const { return size() == rhs.size() && std::equal(begin(), end(), rhs.begin()); }
+        bool operator!=(const flat_map& rhs) const { return !(*this == rhs); }
+
+    private:
+        struct index_compare
+        {
+            const storage_type& m_storage;
+            key_compare         m_comp;
+
+            index_compare(const storage_type& s, const key_compare& c) : m_storage(s), m_comp(c) {}
+
+            bool operator()(index_type l, const key_type& r) const { return m_comp(m_storage[l].first, r); }
+        };
+
+        size_type position(const key_type& k) const
+        {
+            return std::lower_bound(m_order.begin(), m_order.end(), k, index_compare(m_storage, m_comp)) - m_order.begin();
+        }
+
+        iterator insert_at(size_type pos, const value_type& v)
+        {
+            m_storage.push_back(v);
+            m_order.insert(m_order.begin() + pos, index_type(m_storage.size() - 1));
+
+            return iterator(m_order.begin() + pos, &m_storage);
+        }
+
+        storage_type m_storage;
+        order_type   m_order;
+        key_compare  m_comp;
+    };
+
+}}}
+
+#endif // BOOST_PROCESS_DETAIL_FLAT_MAP_HPP
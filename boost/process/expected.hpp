@@ -0,0 +1,57 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_EXPECTED_HPP
+#define BOOST_PROCESS_EXPECTED_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/system/system_error.hpp>
+
+namespace boost { namespace process {
+
+    /// A value or the error_code that prevented it, returned by the *_expected functions
+    /// where a failure is an ordinary outcome, e.g. probing candidate executables, and
+    /// unwinding an exception per failure would cost more than the work itself.
+    ///
+    /// \code
+    ///     bp::expected<bp::child> c = bp::make_child_expected(bp::paths(candidate));
+    ///     if(!c) return c.error(); // or c.value(), which throws the system_error
+    /// \endcode
+    template<class T> class expected
+    {
+    private:
+        struct safe_bool_impl { void true_value() {} };
+        typedef void (safe_bool_impl::*safe_bool)();
+
+    public:
+        expected(const T& value) : m_value(value), m_error() {}
+        expected(const boost::system::error_code& error) : m_value(), m_error(error) {}
+
+        bool has_value() const { return !m_error; }
+
+        operator safe_bool() const { return has_value()? &safe_bool_impl::true_value : 0; }
+
+        /// The value, or throws the error as a system_error.
+        const T& value() const
+        {
+            if(m_error) throw boost::system::system_error(m_error);
+
+            return m_value;
+        }
+
+        const T& operator* () const { return  m_value; }
+        const T* operator->() const { return &m_value; }
+
+        const boost::system::error_code& error() const { return m_error; }
+
+    private:
+        T                         m_value;
+        boost::system::error_code m_error;
+    };
+
+}}
+
+#endif // BOOST_PROCESS_EXPECTED_HPP
@@ -10,12 +10,19 @@
 #define BOOST_PROCESS_MAKE_CHILD_HPP
 
 #include <boost/process/config.hpp>
+#include <boost/system/error_code.hpp>
 
 #include <boost/fusion/container/vector/vector.hpp>
 #include <boost/fusion/container/generation/make_vector.hpp>
 #include <boost/process/child.hpp>
 #include <boost/process/executor.hpp>
+#include <boost/process/expected.hpp>
 #include <boost/process/initializers/check_initializers.hpp>
+#include <boost/static_assert.hpp>
+
+#if defined(BOOST_PROCESS_SEPARATE_COMPILATION) && defined(BOOST_POSIX_API)
+#   include <boost/process/posix/common_launches.hpp>
+#endif
 
 namespace boost { namespace process { 
 
@@ -27,99 +34,264 @@ namespace boost { namespace process {
             // Generate a compiler error if there's an inconsistency in the initializers, for instance
             // if the sequence contains two paths initializers.
             typedef typename check_initializers<InitializerSequence>::type initializers_valid;
+            BOOST_STATIC_ASSERT((initializers_valid::value));
 
             return executor().exec(initializers);
         }
+
+        template< typename InitializerSequence>
+        inline child execute( const InitializerSequence &initializers, boost::system::error_code& ec)
+        {
+            typedef typename check_initializers<InitializerSequence>::type initializers_valid;
+            BOOST_STATIC_ASSERT((initializers_valid::value));
+
+            return executor().exec(initializers, ec);
+        }
+
+        template< typename InitializerSequence>
+        inline expected<child> execute_expected( const InitializerSequence &initializers)
+        {
+            boost::system::error_code ec;
+            child c = execute(initializers, ec);
+
+            return ec? expected<child>(ec) : expected<child>(c);
+        }
     }
 
     template<typename A1>
     inline child make_child(const A1& a1)
     {
         using namespace boost::fusion;
-        using boost::cref;
 
-        return detail::execute(make_vector(cref(a1)));
+        return detail::execute(make_vector(boost::cref(a1)));
     }
 
     template<typename A1, typename A2> 
     inline child make_child(const A1& a1, const A2& a2)
     {
         using namespace boost::fusion;
-        using boost::cref;
 
-        return detail::execute(make_vector(cref(a1), cref(a2)));
+        return detail::execute(make_vector(boost::cref(a1), boost::cref(a2)));
     }
 
     template<typename A1, typename A2, typename A3> 
     inline child make_child(const A1& a1, const A2& a2, const A3& a3)
     {
         using namespace boost::fusion;
-        using boost::cref;
     
-        return detail::execute(make_vector(cref(a1), cref(a2), cref(a3)));
+        return detail::execute(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3)));
     }
 
     template<typename A1, typename A2, typename A3, typename A4> 
     inline child make_child(const A1& a1, const A2& a2, const A3& a3, const A4& a4)
     {
         using namespace boost::fusion;
-        using boost::cref;
 
-        return detail::execute(make_vector(cref(a1), cref(a2), cref(a3), cref(a4)));
+        return detail::execute(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4)));
     }
 
     template<typename A1, typename A2, typename A3, typename A4, typename A5> 
     inline child make_child(const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5)
     {
         using namespace boost::fusion;
-        using boost::cref;
 
-        return detail::execute(make_vector(cref(a1), cref(a2), cref(a3), cref(a4), cref(a5)));
+        return detail::execute(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4), boost::cref(a5)));
     }
 
     template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6> 
     inline child make_child(const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5, const A6& a6)
     {
         using namespace boost::fusion;
-        using boost::cref;
 
-        return detail::execute(make_vector(cref(a1), cref(a2), cref(a3), cref(a4), cref(a5), cref(a6)));
+        return detail::execute(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4), boost::cref(a5), boost::cref(a6)));
     }
 
     template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7> 
     inline child make_child(const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5, const A6& a6, const A7& a7)
     {
         using namespace boost::fusion;
-        using boost::cref;
 
-        return detail::execute(make_vector(cref(a1), cref(a2), cref(a3), cref(a4), cref(a5), cref(a6), cref(a7)));
+        return detail::execute(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4), boost::cref(a5), boost::cref(a6), boost::cref(a7)));
     }
 
     template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8>
     inline child make_child(const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5, const A6& a6, const A7& a7, const A8& a8)
     {
         using namespace boost::fusion;
-        using boost::cref;
 
-        return detail::execute(make_vector(cref(a1), cref(a2), cref(a3), cref(a4), cref(a5), cref(a6), cref(a7), cref(a8)));
+        return detail::execute(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4), boost::cref(a5), boost::cref(a6), boost::cref(a7), boost::cref(a8)));
     }
 
     template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9>
     inline child make_child(const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5, const A6& a6, const A7& a7, const A8& a8, const A9& a9)
     {
         using namespace boost::fusion;
-        using boost::cref;
 
-        return detail::execute(make_vector(cref(a1), cref(a2), cref(a3), cref(a4), cref(a5), cref(a6), cref(a7), cref(a8), cref(a9)));
+        return detail::execute(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4), boost::cref(a5), boost::cref(a6), boost::cref(a7), boost::cref(a8), boost::cref(a9)));
     }
 
     template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10>
     inline child make_child(const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5, const A6& a6, const A7& a7, const A8& a8, const A9& a9, const A10& a10)
     {
         using namespace boost::fusion;
-        using boost::cref;
 
-        return detail::execute(make_vector(cref(a1), cref(a2), cref(a3), cref(a4), cref(a5), cref(a6), cref(a7), cref(a8), cref(a9), cref(a10)));
+        return detail::execute(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4), boost::cref(a5), boost::cref(a6), boost::cref(a7), boost::cref(a8), boost::cref(a9), boost::cref(a10)));
+    }
+
+    // Launches that report failures without throwing: in ec, which is cleared on success, or
+    // in the expected. A child that could not exec is reaped and child() returned, see
+    // executor::exec(izs, ec). For loads where failing launches are common.
+
+    template<typename A1>
+    inline child make_child(boost::system::error_code& ec, const A1& a1)
+    {
+        using namespace boost::fusion;
+
+        return detail::execute(make_vector(boost::cref(a1)), ec);
+    }
+
+    template<typename A1, typename A2>
+    inline child make_child(boost::system::error_code& ec, const A1& a1, const A2& a2)
+    {
+        using namespace boost::fusion;
+
+        return detail::execute(make_vector(boost::cref(a1), boost::cref(a2)), ec);
+    }
+
+    template<typename A1, typename A2, typename A3>
+    inline child make_child(boost::system::error_code& ec, const A1& a1, const A2& a2, const A3& a3)
+    {
+        using namespace boost::fusion;
+
+        return detail::execute(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3)), ec);
+    }
+
+    template<typename A1, typename A2, typename A3, typename A4>
+    inline child make_child(boost::system::error_code& ec, const A1& a1, const A2& a2, const A3& a3, const A4& a4)
+    {
+        using namespace boost::fusion;
+
+        return detail::execute(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4)), ec);
+    }
+
+    template<typename A1, typename A2, typename A3, typename A4, typename A5>
+    inline child make_child(boost::system::error_code& ec, const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5)
+    {
+        using namespace boost::fusion;
+
+        return detail::execute(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4), boost::cref(a5)), ec);
+    }
+
+    template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6>
+    inline child make_child(boost::system::error_code& ec, const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5, const A6& a6)
+    {
+        using namespace boost::fusion;
+
+        return detail::execute(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4), boost::cref(a5), boost::cref(a6)), ec);
+    }
+
+    template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7>
+    inline child make_child(boost::system::error_code& ec, const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5, const A6& a6, const A7& a7)
+    {
+        using namespace boost::fusion;
+
+        return detail::execute(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4), boost::cref(a5), boost::cref(a6), boost::cref(a7)), ec);
+    }
+
+    template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8>
+    inline child make_child(boost::system::error_code& ec, const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5, const A6& a6, const A7& a7, const A8& a8)
+    {
+        using namespace boost::fusion;
+
+        return detail::execute(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4), boost::cref(a5), boost::cref(a6), boost::cref(a7), boost::cref(a8)), ec);
+    }
+
+    template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9>
+    inline child make_child(boost::system::error_code& ec, const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5, const A6& a6, const A7& a7, const A8& a8, const A9& a9)
+    {
+        using namespace boost::fusion;
+
+        return detail::execute(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4), boost::cref(a5), boost::cref(a6), boost::cref(a7), boost::cref(a8), boost::cref(a9)), ec);
+    }
+
+    template<typename A1>
+    inline expected<child> make_child_expected(const A1& a1)
+    {
+        using namespace boost::fusion;
+
+        return detail::execute_expected(make_vector(boost::cref(a1)));
+    }
+
+    template<typename A1, typename A2>
+    inline expected<child> make_child_expected(const A1& a1, const A2& a2)
+    {
+        using namespace boost::fusion;
+
+        return detail::execute_expected(make_vector(boost::cref(a1), boost::cref(a2)));
+    }
+
+    template<typename A1, typename A2, typename A3>
+    inline expected<child> make_child_expected(const A1& a1, const A2& a2, const A3& a3)
+    {
+        using namespace boost::fusion;
+
+        return detail::execute_expected(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3)));
+    }
+
+    template<typename A1, typename A2, typename A3, typename A4>
+    inline expected<child> make_child_expected(const A1& a1, const A2& a2, const A3& a3, const A4& a4)
+    {
+        using namespace boost::fusion;
+
+        return detail::execute_expected(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4)));
+    }
+
+    template<typename A1, typename A2, typename A3, typename A4, typename A5>
+    inline expected<child> make_child_expected(const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5)
+    {
+        using namespace boost::fusion;
+
+        return detail::execute_expected(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4), boost::cref(a5)));
+    }
+
+    template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6>
+    inline expected<child> make_child_expected(const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5, const A6& a6)
+    {
+        using namespace boost::fusion;
+
+        return detail::execute_expected(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4), boost::cref(a5), boost::cref(a6)));
+    }
+
+    template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7>
+    inline expected<child> make_child_expected(const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5, const A6& a6, const A7& a7)
+    {
+        using namespace boost::fusion;
+
+        return detail::execute_expected(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4), boost::cref(a5), boost::cref(a6), boost::cref(a7)));
+    }
+
+    template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8>
+    inline expected<child> make_child_expected(const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5, const A6& a6, const A7& a7, const A8& a8)
+    {
+        using namespace boost::fusion;
+
+        return detail::execute_expected(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4), boost::cref(a5), boost::cref(a6), boost::cref(a7), boost::cref(a8)));
+    }
+
+    template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9>
+    inline expected<child> make_child_expected(const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5, const A6& a6, const A7& a7, const A8& a8, const A9& a9)
+    {
+        using namespace boost::fusion;
+
+        return detail::execute_expected(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4), boost::cref(a5), boost::cref(a6), boost::cref(a7), boost::cref(a8), boost::cref(a9)));
+    }
+
+    template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10>
+    inline expected<child> make_child_expected(const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5, const A6& a6, const A7& a7, const A8& a8, const A9& a9, const A10& a10)
+    {
+        using namespace boost::fusion;
+
+        return detail::execute_expected(make_vector(boost::cref(a1), boost::cref(a2), boost::cref(a3), boost::cref(a4), boost::cref(a5), boost::cref(a6), boost::cref(a7), boost::cref(a8), boost::cref(a9), boost::cref(a10)));
     }
 
 }}
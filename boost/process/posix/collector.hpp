@@ -0,0 +1,633 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_COLLECTOR_HPP
+#define BOOST_PROCESS_POSIX_COLLECTOR_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/child.hpp>
+#include <boost/process/posix/detail/helpers.hpp>
+#include <boost/process/posix/exit_status.hpp>
+#include <boost/process/posix/file_descriptor_ray.hpp>
+#include <boost/process/posix/io_uring.hpp>
+#include <boost/process/posix/pidfd.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+#if !defined(__linux__)
+#   error "collector requires Linux (epoll or io_uring)"
+#endif
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace boost { namespace process { namespace posix {
+
+    /// Drains any number of child pipes on the calling thread.
+    ///
+    /// A child writing to both stdout and stderr stalls as soon as the pipe the parent
+    /// does not read from is full. The collector waits on all added sources at once and
+    /// reads whichever is ready, appending to a string or handing the data to a callback,
+    /// either in chunks as read or split into lines. It can also feed children's stdin and
+    /// report their exits, so one loop serves all of a child's I/O.
+    ///
+    /// There are two backends. The epoll one waits for readiness and then reads, two system
+    /// calls per chunk. The io_uring one keeps a read queued on every source, with the kernel
+    /// picking one of a set of buffers registered with the ring once data arrives, so idle
+    /// sources hold no buffer and one io_uring_enter submits and collects a whole batch.
+    /// automatic takes io_uring where the kernel has what it needs (Linux 5.11), else epoll.
+    ///
+    /// Callbacks may add sources, writes and watched exits to the collector running them.
+    ///
+    /// \code
+    ///     bp::file_descriptor_ray out, err;
+    ///     bp::monitor m(bp::make_child(bp::paths(exe), bp::std_out_to(out), bp::std_err_to(err)));
+    ///     std::string out_text, err_text;
+    ///     bp::posix::collector c;
+    ///     c.add(out, out_text);
+    ///     c.add(err, err_text);
+    ///     c.run();
+    ///     m.join();
+    /// \endcode
+    class collector : private boost::noncopyable
+    {
+    public:
+        /// Receives the data read from a source, in lines mode a line without its '\n'.
+        typedef boost::function<void (const char*, std::size_t)> callback_type;
+
+        /// Receives a watched child once it exited and was reaped.
+        typedef boost::function<void (pid_t, exit_status)> exit_callback_type;
+
+        enum mode_type { chunks, lines };
+
+        enum backend_type { automatic, epoll_backend, uring_backend };
+
+        enum { chunk_size = 64 * 1024, default_uring_entries = 1024, default_uring_buffers = 64 };
+
+        /// With io_uring, uring_buffers chunks are registered for reads; more only help if
+        /// that many sources have data at the same moment. uring_entries is the size of the
+        /// submission queue, which is submitted early whenever a batch fills it.
+        explicit collector(backend_type backend = automatic, unsigned uring_buffers = default_uring_buffers, unsigned uring_entries = default_uring_entries)
+            : m_epoll(-1), m_ring(), m_buffers(), m_open(0), m_writing(0), m_watching(0), m_chunk(chunk_size)
+        {
+            if(backend != epoll_backend)
+            {
+                try
+                {
+                    m_ring.reset(new io_uring_ring(uring_entries));
+                    m_buffers.resize(std::size_t(uring_buffers) * chunk_size);
+                    provide_buffers(0, uring_buffers);
+                }
+                catch(const boost::system::system_error&)
+                {
+                    if(backend == uring_backend) throw;
+                    m_ring.reset();
+                    m_buffers.clear();
+                }
+            }
+            if(!m_ring)
+            {
+                m_epoll = ::epoll_create1(EPOLL_CLOEXEC);
+                if(m_epoll == -1) detail::throw_last_error();
+            }
+        }
+
+        ~collector()
+        {
+            for(std::size_t i = 0; i < m_writes.size(); ++i) if(m_writes[i].m_fd != -1) close(m_writes[i].m_fd);
+            for(std::size_t i = 0; i < m_exits.size();  ++i) if(m_exits[i].m_pidfd != -1) close(m_exits[i].m_pidfd);
+
+            // the ring goes first, cancelling what is still queued on the buffers
+            m_ring.reset();
+            if(m_epoll != -1) close(m_epoll);
+        }
+
+        backend_type backend() const { return m_ring? uring_backend : epoll_backend; }
+
+        /// Appends everything read from the ray to buffer. Closes the parent's copy of the
+        /// ray's sink, which has to happen after the launch for the source to reach EOF.
+        std::size_t add(file_descriptor_ray& r, std::string& buffer)
+        {
+            r.m_sink.close();
+            return add(r.m_source.handle(), &buffer, callback_type(), chunks);
+        }
+
+        std::size_t add(file_descriptor_ray& r, const callback_type& cb, mode_type mode = chunks)
+        {
+            r.m_sink.close();
+            return add(r.m_source.handle(), 0, cb, mode);
+        }
+
+        /// Sources given as plain fds stay owned by the caller.
+        std::size_t add(int fd, std::string& buffer)                              { return add(fd, &buffer, callback_type(), chunks); }
+        std::size_t add(int fd, const callback_type& cb, mode_type mode = chunks) { return add(fd, 0, cb, mode); }
+
+        /// Writes a copy of data to the ray's sink, for a child reading it through
+        /// std_in_from, and closes the sink once all is written, so the child sees EOF.
+        /// Closes the parent's copy of the ray's source. A child that exits without reading
+        /// everything just ends the write.
+        void write(file_descriptor_ray& r, const std::string& data)
+        {
+            r.m_source.close();
+
+            pending_write w;
+            w.m_fd     = ::fcntl(r.m_sink.handle(), F_DUPFD_CLOEXEC, 3);
+            w.m_data   = data;
+            w.m_offset = 0;
+            if(w.m_fd == -1) detail::throw_last_error();
+            r.m_sink.close();
+
+            const std::size_t i = m_writes.size();
+            m_writes.push_back(w);
+            ++m_writing;
+
+            if(data.empty())    finish_write(i);
+            else if(m_ring)     submit_write(i);
+            else
+            {
+                ::fcntl(w.m_fd, F_SETFL, ::fcntl(w.m_fd, F_GETFL) | O_NONBLOCK);
+                epoll_add(w.m_fd, EPOLLOUT, write_kind | boost::uint32_t(i));
+            }
+        }
+
+        /// Calls cb once the child exited, after reaping it. Needs pidfds (Linux 5.3).
+        void watch_exit(const child& c, const exit_callback_type& cb)
+        {
+            watched_exit x;
+            x.m_pid      = c.handle();
+            x.m_pidfd    = pidfd::open(x.m_pid);
+            x.m_callback = cb;
+            if(x.m_pidfd == -1) detail::throw_last_error();
+
+            const std::size_t i = m_exits.size();
+            m_exits.push_back(x);
+            ++m_watching;
+
+            if(m_ring)
+            {
+                io_uring_sqe& s = m_ring->get_sqe();
+                s.opcode        = IORING_OP_POLL_ADD;
+                s.fd            = x.m_pidfd;
+                s.poll32_events = POLLIN;
+                s.user_data     = user_data(exit_kind, i);
+            }
+            else epoll_add(x.m_pidfd, EPOLLIN, exit_kind | boost::uint32_t(i));
+        }
+
+        /// Number of sources that did not reach EOF yet.
+        std::size_t open_sources() const { return m_open; }
+
+        /// Number of writes not finished and watched children not reaped yet.
+        std::size_t pending_writes() const { return m_writing; }
+        std::size_t pending_exits()  const { return m_watching; }
+
+        /// Runs until all sources reached EOF, all writes are done and all watched children
+        /// were reaped.
+        void run()
+        {
+            while(m_open || m_writing || m_watching) run_one(-1);
+        }
+
+        /// Waits up to timeout_ms milliseconds, -1 for no limit, and handles everything that
+        /// is ready. Returns false on timeout.
+        bool run_one(int timeout_ms)
+        {
+            if(!m_open && !m_writing && !m_watching) return false;
+
+            return m_ring? run_one_uring(timeout_ms) : run_one_epoll(timeout_ms);
+        }
+
+    private:
+        // epoll keeps the kind in the top bits of the event's u32, io_uring in user_data
+        enum { index_mask = 0x3fffffff };
+
+        static const boost::uint32_t read_kind    = 0;
+        static const boost::uint32_t write_kind   = 0x40000000u;
+        static const boost::uint32_t exit_kind    = 0x80000000u;
+        static const boost::uint32_t provide_kind = 0xc0000000u;
+
+        struct source
+        {
+            int           m_fd;
+            std::string*  m_buffer;
+            callback_type m_callback;
+            mode_type     m_mode;
+            std::string   m_partial_line;
+        };
+
+        struct pending_write
+        {
+            int         m_fd;     // -1 once done
+            std::string m_data;
+            std::size_t m_offset;
+        };
+
+        struct watched_exit
+        {
+            pid_t              m_pid;
+            int                m_pidfd; // -1 once reaped
+            exit_callback_type m_callback;
+        };
+
+        /// Pipes raise SIGPIPE for a write after the reader exited; it is blocked for this
+        /// thread while writing, and taken back if the write raised it.
+        struct sigpipe_guard
+        {
+            sigpipe_guard()
+            {
+                sigemptyset(&m_pipe);
+                sigaddset(&m_pipe, SIGPIPE);
+
+                sigset_t pending;
+                sigpending(&pending);
+                m_was_pending = sigismember(&pending, SIGPIPE);
+
+                pthread_sigmask(SIG_BLOCK, &m_pipe, &m_old);
+            }
+
+            ~sigpipe_guard()
+            {
+                if(!m_was_pending)
+                {
+                    sigset_t pending;
+                    sigpending(&pending);
+
+                    timespec none = { 0, 0 };
+                    if(sigismember(&pending, SIGPIPE)) sigtimedwait(&m_pipe, 0, &none);
+                }
+                pthread_sigmask(SIG_SETMASK, &m_old, 0);
+            }
+
+            sigset_t m_pipe, m_old;
+            bool     m_was_pending;
+        };
+
+        std::size_t add(int fd, std::string* buffer, const callback_type& cb, mode_type mode)
+        {
+            source s;
+            s.m_fd = fd; s.m_buffer = buffer; s.m_callback = cb; s.m_mode = mode;
+
+            const std::size_t i = m_sources.size();
+            m_sources.push_back(s);
+            ++m_open;
+
+            if(m_ring) submit_read(i);
+            else       epoll_add(fd, EPOLLIN, read_kind | boost::uint32_t(i));
+
+            return i;
+        }
+
+        // epoll
+
+        void epoll_add(int fd, boost::uint32_t events, boost::uint32_t data)
+        {
+            epoll_event ev;
+            std::memset(&ev, 0, sizeof(ev));
+            ev.events   = events;
+            ev.data.u32 = data;
+
+            if(::epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &ev) == -1) detail::throw_last_error();
+        }
+
+        bool run_one_epoll(int timeout_ms)
+        {
+            epoll_event events[16];
+
+            int n = ::epoll_wait(m_epoll, events, 16, timeout_ms);
+            if(n == -1)
+            {
+                if(errno == EINTR) return true;
+                detail::throw_last_error();
+            }
+            for(int i = 0; i < n; ++i)
+            {
+                const boost::uint32_t kind  = events[i].data.u32 & ~boost::uint32_t(index_mask);
+                const std::size_t     index = events[i].data.u32 &  index_mask;
+
+                if(kind == read_kind)       drain(m_sources[index]);
+                else if(kind == write_kind) write_some(index);
+                else                        reap(index);
+            }
+
+            return n > 0;
+        }
+
+        /// One read per readiness keeps the sources fair; level triggering brings us back.
+        void drain(source& s)
+        {
+            ssize_t n;
+            if(s.m_buffer)
+            {
+                // read straight into the string's tail
+                std::string& b = *s.m_buffer;
+                const std::size_t used = b.size();
+                b.resize(used + chunk_size);
+                n = read(s.m_fd, &b[used], chunk_size);
+                b.resize(used + ((n > 0)? std::size_t(n) : 0));
+            }
+            else
+            {
+                n = read(s.m_fd, &m_chunk[0], chunk_size);
+                if(n > 0) deliver(s, &m_chunk[0], std::size_t(n));
+            }
+
+            if(n == -1)
+            {
+                if(errno == EINTR || errno == EAGAIN) return;
+                detail::throw_last_error();
+            }
+            if(n == 0) finish(s);
+        }
+
+        void write_some(std::size_t i)
+        {
+            pending_write& w = m_writes[i];
+
+            ssize_t n;
+            {
+                sigpipe_guard guard;
+                n = ::write(w.m_fd, w.m_data.data() + w.m_offset, w.m_data.size() - w.m_offset);
+            }
+
+            if(n == -1)
+            {
+                if(errno == EINTR || errno == EAGAIN) return;
+                if(errno != EPIPE) detail::throw_last_error();
+            }
+            else w.m_offset += std::size_t(n);
+
+            if(n == -1 || w.m_offset == w.m_data.size()) finish_write(i);
+        }
+
+        // io_uring
+
+        static boost::uint64_t user_data(boost::uint32_t kind, std::size_t index)
+        {
+            return (boost::uint64_t(kind) << 32) | index;
+        }
+
+        void provide_buffers(unsigned first, unsigned count)
+        {
+            io_uring_sqe& s = m_ring->get_sqe();
+            s.opcode    = IORING_OP_PROVIDE_BUFFERS;
+            s.fd        = int(count);
+            s.addr      = reinterpret_cast<boost::uint64_t>(&m_buffers[std::size_t(first) * chunk_size]);
+            s.len       = chunk_size;
+            s.off       = first;
+            s.buf_group = 0;
+            s.user_data = user_data(provide_kind, 0);
+        }
+
+        void submit_read(std::size_t i, bool after_poll = false)
+        {
+            if(after_poll) submit_poll(m_sources[i].m_fd, POLLIN);
+
+            io_uring_sqe& s = m_ring->get_sqe();
+            s.opcode    = IORING_OP_READ;
+            s.fd        = m_sources[i].m_fd;
+            s.len       = chunk_size;
+            s.off       = boost::uint64_t(-1);
+            s.flags     = IOSQE_BUFFER_SELECT;
+            s.buf_group = 0;
+            s.user_data = user_data(read_kind, i);
+        }
+
+        void submit_write(std::size_t i, bool after_poll = false)
+        {
+            pending_write& w = m_writes[i];
+            if(after_poll) submit_poll(w.m_fd, POLLOUT);
+
+            io_uring_sqe& s = m_ring->get_sqe();
+            s.opcode    = IORING_OP_WRITE;
+            s.fd        = w.m_fd;
+            s.addr      = reinterpret_cast<boost::uint64_t>(w.m_data.data() + w.m_offset);
+            s.len       = unsigned(w.m_data.size() - w.m_offset);
+            s.off       = boost::uint64_t(-1);
+            s.user_data = user_data(write_kind, i);
+        }
+
+        /// For fds opened non-blocking, where io_uring does not poll by itself: the next
+        /// entry waits for readiness.
+        void submit_poll(int fd, unsigned events)
+        {
+            io_uring_sqe& s = m_ring->get_sqe();
+            s.opcode        = IORING_OP_POLL_ADD;
+            s.fd            = fd;
+            s.poll32_events = events;
+            s.flags         = IOSQE_IO_LINK;
+            s.user_data     = user_data(provide_kind, 0);
+        }
+
+        struct completion_handler
+        {
+            collector& m_c;
+            explicit completion_handler(collector& c) : m_c(c) {}
+            void operator()(const io_uring_cqe& cqe) const { m_c.complete(cqe); }
+        };
+
+        bool run_one_uring(int timeout_ms)
+        {
+            // starved reads are queued again after the buffers that were given back
+            std::vector<std::size_t> starved;
+            starved.swap(m_starved);
+            for(std::size_t i = 0; i < starved.size(); ++i) submit_read(starved[i]);
+
+            bool ready;
+            if(m_writing)
+            {
+                sigpipe_guard guard; // writes issued inline run on this thread
+                ready = m_ring->submit_and_wait(timeout_ms);
+            }
+            else ready = m_ring->submit_and_wait(timeout_ms);
+
+            completion_handler h(*this);
+            m_ring->consume(h);
+
+            return ready;
+        }
+
+        void complete(const io_uring_cqe& cqe)
+        {
+            const boost::uint32_t kind  = boost::uint32_t(cqe.user_data >> 32);
+            const std::size_t     index = std::size_t(cqe.user_data & index_mask);
+
+            if(kind == read_kind)
+            {
+                source& s = m_sources[index];
+
+                const bool     taken  = (cqe.flags & IORING_CQE_F_BUFFER) != 0;
+                const unsigned buffer = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+
+                if(cqe.res > 0)
+                {
+                    const char* data = &m_buffers[std::size_t(buffer) * chunk_size];
+
+                    try
+                    {
+                        if(s.m_buffer) s.m_buffer->append(data, std::size_t(cqe.res));
+                        else           deliver(s, data, std::size_t(cqe.res));
+                    }
+                    catch(...)
+                    {
+                        if(taken) provide_buffers(buffer, 1);
+                        throw;
+                    }
+                }
+
+                // a buffer taken is given back, even by a read that ended in EOF, but only once
+                // its data is read: a full submission queue makes get_sqe submit right away, and
+                // a read in flight could then take the chunk
+                if(taken) provide_buffers(buffer, 1);
+
+                if(cqe.res > 0)                submit_read(index);
+                else if(cqe.res == 0)          finish(s);
+                else if(cqe.res == -ENOBUFS)   m_starved.push_back(index);
+                else if(cqe.res == -EAGAIN)    submit_read(index, true);
+                else if(cqe.res == -EINTR)     submit_read(index);
+                else                           detail::throw_error(-cqe.res);
+            }
+            else if(kind == write_kind)
+            {
+                pending_write& w = m_writes[index];
+
+                if(cqe.res >= 0)
+                {
+                    w.m_offset += std::size_t(cqe.res);
+                    if(w.m_offset == w.m_data.size()) finish_write(index);
+                    else                              submit_write(index);
+                }
+                else if(cqe.res == -EPIPE)  finish_write(index);
+                else if(cqe.res == -EAGAIN) submit_write(index, true);
+                else if(cqe.res == -EINTR)  submit_write(index);
+                else                        detail::throw_error(-cqe.res);
+            }
+            else if(kind == exit_kind)
+            {
+                if(cqe.res < 0) detail::throw_error(-cqe.res);
+                reap(index);
+            }
+            else if(cqe.res < 0 && cqe.res != -ECANCELED)
+            {
+                detail::throw_error(-cqe.res);
+            }
+        }
+
+        // shared
+
+        void deliver(source& s, const char* data, std::size_t len)
+        {
+            if(s.m_mode == chunks)
+            {
+                s.m_callback(data, len);
+                return;
+            }
+
+            const char* end = data + len;
+            for(const char* nl; (nl = static_cast<const char*>(std::memchr(data, '\n', end - data))) != 0; data = nl + 1)
+            {
+                if(s.m_partial_line.empty())
+                {
+                    s.m_callback(data, nl - data);
+                }
+                else
+                {
+                    s.m_partial_line.append(data, nl);
+                    s.m_callback(s.m_partial_line.data(), s.m_partial_line.size());
+                    s.m_partial_line.clear();
+                }
+            }
+            s.m_partial_line.append(data, end);
+        }
+
+        void finish(source& s)
+        {
+            if(!m_ring && ::epoll_ctl(m_epoll, EPOLL_CTL_DEL, s.m_fd, 0) == -1) detail::throw_last_error();
+            --m_open;
+
+            // an unterminated last line is still a line
+            if(!s.m_partial_line.empty())
+            {
+                s.m_callback(s.m_partial_line.data(), s.m_partial_line.size());
+                s.m_partial_line.clear();
+            }
+        }
+
+        void finish_write(std::size_t i)
+        {
+            pending_write& w = m_writes[i];
+
+            // closing the fd alone leaves it in the epoll set while a child forked since has a copy
+            if(!m_ring && ::epoll_ctl(m_epoll, EPOLL_CTL_DEL, w.m_fd, 0) == -1 && errno != ENOENT) detail::throw_last_error();
+            close(w.m_fd);
+            w.m_fd = -1;
+            std::string().swap(w.m_data);
+            --m_writing;
+        }
+
+        void reap(std::size_t i)
+        {
+            watched_exit& x = m_exits[i];
+
+            siginfo_t info;
+            std::memset(&info, 0, sizeof(info));
+
+            exit_status status;
+            if(pidfd::wait(x.m_pidfd, info, WEXITED) == 0)
+            {
+                status = exit_status(info);
+            }
+            else
+            {
+                int raw = 0;
+                pid_t p;
+                while((p = ::waitpid(x.m_pid, &raw, 0)) == -1 && errno == EINTR) {}
+                if(p == -1) detail::throw_last_error();
+
+                status = exit_status(raw);
+            }
+
+            // as for writes, closing alone leaves the pidfd in the epoll set
+            if(!m_ring && ::epoll_ctl(m_epoll, EPOLL_CTL_DEL, x.m_pidfd, 0) == -1) detail::throw_last_error();
+            close(x.m_pidfd);
+            x.m_pidfd = -1;
+            --m_watching;
+
+            // the callback is done with once called, and may watch more exits
+            const pid_t pid = x.m_pid;
+            exit_callback_type cb;
+            cb.swap(x.m_callback);
+            cb(pid, status);
+        }
+
+        int                              m_epoll;   // -1 with io_uring
+        boost::scoped_ptr<io_uring_ring> m_ring;    // empty with epoll
+        std::vector<char>                m_buffers; // registered with the ring, chunk_size each
+        std::size_t                      m_open;
+        std::size_t                      m_writing;
+        std::size_t                      m_watching;
+        std::deque<source>               m_sources; // a deque: callbacks may add while one runs
+        std::vector<pending_write>       m_writes;
+        std::deque<watched_exit>         m_exits;
+        std::vector<std::size_t>         m_starved; // reads that found no buffer
+        std::vector<char>                m_chunk;
+    };
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_COLLECTOR_HPP
@@ -0,0 +1,63 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_COMMON_LAUNCHES_HPP
+#define BOOST_PROCESS_POSIX_COMMON_LAUNCHES_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/executor.hpp>
+#include <boost/process/posix/initializers/args.hpp>
+#include <boost/process/posix/initializers/paths.hpp>
+#include <boost/process/posix/initializers/std_io.hpp>
+#include <boost/process/posix/initializers/throw_on_launch_error.hpp>
+#include <boost/fusion/container/generation/make_vector.hpp>
+#include <boost/ref.hpp>
+
+namespace boost { namespace process { namespace posix {
+
+    /// The initializer sequences make_child builds for the most common launches. With
+    /// BOOST_PROCESS_SEPARATE_COMPILATION their executor hooks are compiled once, in
+    /// libs/process/src/executor.cpp, and only declared in the program's translation units.
+    namespace common_launches
+    {
+        typedef boost::reference_wrapper<const paths>                   paths_ref;
+        typedef boost::reference_wrapper<const args>                    args_ref;
+        typedef boost::reference_wrapper<const std_in_from>             std_in_ref;
+        typedef boost::reference_wrapper<const std_out_to>              std_out_ref;
+        typedef boost::reference_wrapper<const std_err_to>              std_err_ref;
+        typedef boost::reference_wrapper<const throw_on_launch_error<> > throw_ref;
+
+        typedef boost::fusion::result_of::make_vector<paths_ref                                             >::type paths_only;
+        typedef boost::fusion::result_of::make_vector<paths_ref, args_ref                                   >::type paths_args;
+        typedef boost::fusion::result_of::make_vector<paths_ref, args_ref, std_out_ref                      >::type paths_args_out;
+        typedef boost::fusion::result_of::make_vector<paths_ref, args_ref, std_in_ref,  std_out_ref         >::type paths_args_in_out;
+        typedef boost::fusion::result_of::make_vector<paths_ref, args_ref, std_out_ref, std_err_ref         >::type paths_args_out_err;
+        typedef boost::fusion::result_of::make_vector<paths_ref, throw_ref                                  >::type paths_throw;
+        typedef boost::fusion::result_of::make_vector<paths_ref, args_ref, throw_ref                        >::type paths_args_throw;
+        typedef boost::fusion::result_of::make_vector<paths_ref, args_ref, std_out_ref, throw_ref           >::type paths_args_out_throw;
+    }
+
+#if defined(BOOST_PROCESS_SEPARATE_COMPILATION) && !defined(BOOST_NO_CXX11_EXTERN_TEMPLATE)
+#   if defined(BOOST_PROCESS_INSTANTIATE_COMMON_LAUNCHES)
+#       define BOOST_PROCESS_COMMON_LAUNCH(SEQUENCE) template struct executor::erased_hooks<common_launches::SEQUENCE>;
+#   else
+#       define BOOST_PROCESS_COMMON_LAUNCH(SEQUENCE) extern template struct executor::erased_hooks<common_launches::SEQUENCE>;
+#   endif
+
+    BOOST_PROCESS_COMMON_LAUNCH(paths_only)
+    BOOST_PROCESS_COMMON_LAUNCH(paths_args)
+    BOOST_PROCESS_COMMON_LAUNCH(paths_args_out)
+    BOOST_PROCESS_COMMON_LAUNCH(paths_args_in_out)
+    BOOST_PROCESS_COMMON_LAUNCH(paths_args_out_err)
+    BOOST_PROCESS_COMMON_LAUNCH(paths_throw)
+    BOOST_PROCESS_COMMON_LAUNCH(paths_args_throw)
+    BOOST_PROCESS_COMMON_LAUNCH(paths_args_out_throw)
+
+#   undef BOOST_PROCESS_COMMON_LAUNCH
+#endif
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_COMMON_LAUNCHES_HPP
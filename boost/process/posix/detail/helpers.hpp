@@ -0,0 +1,83 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_DETAIL_HELPERS_HPP
+#define BOOST_PROCESS_POSIX_DETAIL_HELPERS_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <cerrno>
+
+#include <pthread.h>
+#include <time.h>
+
+namespace boost { namespace process { namespace posix { namespace detail {
+
+    inline void throw_error(int error)
+    {
+        throw boost::system::system_error(boost::system::error_code(error, boost::system::system_category()));
+    }
+
+    inline void throw_last_error() { throw_error(errno); }
+
+    /// Milliseconds of the monotonic clock.
+    inline long long now_ms()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+
+        return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+    }
+
+    /// Milliseconds of the monotonic clock at tick resolution, cheaper where the kernel has
+    /// CLOCK_MONOTONIC_COARSE.
+    inline long long coarse_now_ms()
+    {
+#if defined(CLOCK_MONOTONIC_COARSE)
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+
+        return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#else
+        return now_ms();
+#endif
+    }
+
+    /// The one T of the process, constructed by the first instance() call of any thread and
+    /// never destroyed, so children may still be launched from static destructors. A T whose
+    /// constructor throws is never created, instance() throws EAGAIN then and from then on.
+    /// A T with a private constructor befriends leaked_singleton<T>.
+    template<class T>
+    class leaked_singleton
+    {
+    public:
+        static T& instance()
+        {
+            static pthread_once_t once = PTHREAD_ONCE_INIT;
+            pthread_once(&once, &create);
+
+            if(!instance_ptr()) throw_error(EAGAIN);
+
+            return *instance_ptr();
+        }
+
+    private:
+        static T*& instance_ptr()
+        {
+            static T* t = 0;
+            return t;
+        }
+
+        // an exception must not leave pthread_once
+        static void create()
+        {
+            try { instance_ptr() = new T(); } catch(...) {}
+        }
+    };
+
+}}}}
+
+#endif // BOOST_PROCESS_POSIX_DETAIL_HELPERS_HPP
@@ -15,27 +15,41 @@
 #include <boost/optional.hpp>
 #include <boost/process/posix/child.hpp>
 #include <boost/process/posix/initializers/initializer.hpp>
+#include <boost/process/posix/launch_error.hpp>
+#include <boost/fusion/include/mpl.hpp>
+#include <boost/mpl/end.hpp>
+#include <boost/mpl/find_if.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/system/system_error.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/type_traits/remove_cv.hpp>
+#include <boost/type_traits/remove_reference.hpp>
 
-#include <csignal>
 #include <set>
+#include <utility>
 #include <vector>
 
 #include <sys/types.h>
 #include <unistd.h>
 #include <fcntl.h>
-#include <signal.h>
-
-//////////////////////////////////////////////////////////////////
-#define BOOST_PROCESS_EXECUTOR_METHOD(fnc)                        \
-                                                                  \
-template<typename INITIALIZERS> void fnc(const INITIALIZERS& izs) \
-{                                                                 \
-    boost::fusion::for_each(izs, initializer::lazy::fnc<executor>(*this));  \
-}
-//////////////////////////////////////////////////////////////////
 
 namespace boost { namespace process { namespace posix {
 
+    /// Launches a child from a sequence of initializers.
+    ///
+    /// Children can be launched from many threads at once, as long as every launch uses its
+    /// own initializer objects, which keep per launch state. All fds the library creates are
+    /// close-on-exec from the start, no process wide signal disposition is changed, and the
+    /// child closes every fd from 3 up except the ones the initializers set in use. So a
+    /// child never inherits fds another thread opens while it is launched.
+    ///
+    /// The child is created by the backend launch_backend chooses: forked, without the memory
+    /// registered with fork_regions, or sharing the parent's memory until it exec'd.
+    ///
+    /// Only the hooks are compiled per initializer sequence: exec passes them as hooks to
+    /// launch, which forks and execs for all sequences alike. launch and the other members
+    /// declared BOOST_PROCESS_DECL are defined in impl/executor.ipp, inline by default, or
+    /// compiled once into the library with BOOST_PROCESS_SEPARATE_COMPILATION, see config.hpp.
     struct executor 
     {
         typedef boost::filesystem::path      path;
@@ -43,133 +57,189 @@ namespace boost { namespace process { namespace posix {
         typedef int          file_descriptor_type;
         typedef pid_t                    pid_type;
 
-        executor() : m_exe(), m_arg_ptrs(), m_env_vars_ptrs(0), m_fd_map(), m_pid(-1), m_optional_error_pipe() {}
+        executor() : m_exe(), m_exe_fd(-1), m_child_main(0), m_child_main_arg(0), m_arg_ptrs(), m_env_vars_ptrs(0), m_env_additions(), m_env_storage(), m_fd_map(), m_pid(-1), m_optional_error_pipe(), m_stage(launch_report::no_stage), m_initializer(-1), m_error_code(0) {}
         
+        /// The hooks of a launch's initializers behind function pointers, each running one
+        /// hook of all of them in sequence order.
+        struct hooks
+        {
+            typedef void (*hook_type)(executor&, const void*);
+
+            const void* m_initializers;
+            hook_type   m_pre_fork_parent;
+            hook_type   m_post_fork_parent;
+            hook_type   m_failed_fork_parent;
+            hook_type   m_post_fork_child; // counts m_initializer up
+            hook_type   m_failed_exec_child;
+            bool        m_shares_child_memory;
+        };
+
         template<typename INITIALIZERS> child exec(const INITIALIZERS& izs)
         {
-            pre_fork_parent(izs);
-            
-            if(m_optional_error_pipe) (*m_optional_error_pipe).pre_fork_parent(*this);
-            
-            switch(m_pid = fork())
-            {
-                case  0:   post_fork_child (izs); break; 
-                default:   post_fork_parent(izs); break; 
-                case -1: failed_fork_parent(izs); break;
-            }
-            
-            return child(m_pid);
+            return launch(erased_hooks<INITIALIZERS>::make(izs));
         }
 
-        template<typename INITIALIZERS> void post_fork_child(const INITIALIZERS& izs)
+        /// As exec, but every failure a system_error would report, including the child's
+        /// failure to exec, ends up in ec instead: the error pipe is always used, and a child
+        /// that failed is reaped and child() returned. Nothing is thrown for them, also not
+        /// by throw_on_launch_error, so failing launches cost no unwinding.
+        template<typename INITIALIZERS> child exec(const INITIALIZERS& izs, boost::system::error_code& ec)
         {
-            boost::fusion::for_each(izs, initializer::lazy::post_fork_child<executor>(*this));
-            
-            m_fd_map.set_child_std_fds();
-            m_fd_map. close_unused_fds();
-        
-            execve(m_exe.c_str(), m_arg_ptrs.ptr(), m_env_vars_ptrs); // doesn't return on success
-            
-            failed_exec_child(izs);
+            return launch(erased_hooks<INITIALIZERS>::make(izs), ec);
         }
-        
-        BOOST_PROCESS_EXECUTOR_METHOD(   pre_fork_parent)
-        BOOST_PROCESS_EXECUTOR_METHOD(  post_fork_parent)
-        BOOST_PROCESS_EXECUTOR_METHOD(failed_fork_parent)
-        BOOST_PROCESS_EXECUTOR_METHOD(failed_exec_child )
+
+        /// Creates the child by the chosen backend and runs the hooks on either side.
+        BOOST_PROCESS_DECL child launch(const hooks& h);
+        BOOST_PROCESS_DECL child launch(const hooks& h, boost::system::error_code& ec);
+
+        /// The child's side: runs the hooks, sets up the fds and execs, or reports and _exits.
+        BOOST_PROCESS_DECL void post_fork_child(const hooks& h);
+
+        /// In place of exec: the launch succeeded as far as the parent is concerned, the
+        /// child runs m_child_main and exits with its result.
+        BOOST_PROCESS_DECL void run_child_main();
+
+        /// True if every initializer's post_fork_child may run in a child sharing the parent's memory.
+        template<typename INITIALIZERS> struct shares_child_memory
+        {
+            struct copies
+            {
+                template<class I> struct apply
+                {
+                    typedef typename boost::remove_cv<typename boost::remove_reference<I>::type>::type initializer_type;
+                    typedef typename boost::is_same<typename initializer_type::child_memory_category, child_memory::copied>::type type;
+                };
+            };
+
+            static const bool value = boost::is_same<typename boost::mpl::find_if<INITIALIZERS, copies>::type, typename boost::mpl::end<INITIALIZERS>::type>::value;
+        };
+
+        /// The hooks of an initializer sequence, the only code compiled per sequence.
+        template<typename INITIALIZERS> struct erased_hooks
+        {
+            static hooks make(const INITIALIZERS& izs)
+            {
+                hooks h = { &izs, &pre_fork_parent, &post_fork_parent, &failed_fork_parent, &post_fork_child, &failed_exec_child, shares_child_memory<INITIALIZERS>::value };
+                return h;
+            }
+
+            static void    pre_fork_parent(executor& e, const void* izs) { boost::fusion::for_each(sequence(izs), initializer::lazy::   pre_fork_parent<executor>(e)); }
+            static void   post_fork_parent(executor& e, const void* izs) { boost::fusion::for_each(sequence(izs), initializer::lazy::  post_fork_parent<executor>(e)); }
+            static void failed_fork_parent(executor& e, const void* izs) { boost::fusion::for_each(sequence(izs), initializer::lazy::failed_fork_parent<executor>(e)); }
+            static void   post_fork_child (executor& e, const void* izs) { boost::fusion::for_each(sequence(izs), indexed_post_fork_child(e)); }
+            static void failed_exec_child (executor& e, const void* izs) { boost::fusion::for_each(sequence(izs), initializer::lazy::failed_exec_child <executor>(e)); }
+
+            static const INITIALIZERS& sequence(const void* izs) { return *static_cast<const INITIALIZERS*>(izs); }
+        };
+
+        /// Starts the child with clone(CLONE_VM|CLONE_VFORK), on a stack of its own, and returns
+        /// once it exec'd or exited. Signals stay blocked until the child reset the handlers,
+        /// which would otherwise run on the parent's memory.
+        struct vfork_start;
+
+        BOOST_PROCESS_DECL pid_type vfork_child(const hooks& h);
 
         void set_std_in (file_descriptor_type fd) { m_fd_map.set_std_in (fd); }
         void set_std_out(file_descriptor_type fd) { m_fd_map.set_std_out(fd); }
         void set_std_err(file_descriptor_type fd) { m_fd_map.set_std_err(fd); }
         void set_in_use (file_descriptor_type fd) { m_fd_map.set_in_use (fd); }
+
+        /// Call from pre_fork_parent: the child gets parent_fd as child_fd.
+        void inherit_fd(file_descriptor_type parent_fd, file_descriptor_type child_fd) { m_fd_map.inherit(parent_fd, child_fd); }
+
+        /// Call from pre_fork_parent: adds a "name=value" entry to the child's environment,
+        /// replacing an entry of the same name. The entry is not copied, so a post_fork_child
+        /// hook may still fill in its value in place, e.g. with the child's pid.
+        void add_child_env(char_type* entry) { m_env_additions.push_back(entry); }
         
         void use_error_pipe() 
         { 
             if(!m_optional_error_pipe) 
             {
                 m_optional_error_pipe = error_directed_pipe();
-                
-                (*m_optional_error_pipe).post_fork_child(*this);
             }
         }
         
-        void child_throw(int err)
+        /// Reports a failure from the child side and terminates the child, whether or not
+        /// anyone in the parent is listening on the error pipe.
+        void child_throw(int err, const char* what = 0, const char* detail = 0)
+        {
+            if(m_optional_error_pipe) (*m_optional_error_pipe).child_throw(m_stage, m_initializer, err, what, detail);
+
+            _exit(127);
+        }
+
+        template<class EXC> void parent_throw_if()
+        {
+            if(m_optional_error_pipe && (*m_optional_error_pipe).parent_read()) parent_throw<EXC>((*m_optional_error_pipe).m_report);
+        }
+
+        /// Throws the report as EXC, or stores its errno in the error_code of exec(izs, ec).
+        template<class EXC> void parent_throw(const launch_report& r)
         {
-            if(m_optional_error_pipe) (*m_optional_error_pipe).child_throw(err);    
+            if(m_error_code) { if(!*m_error_code) m_error_code->assign(r.m_errno, boost::system::system_category()); }
+            else             throw launch_exception<EXC>::make(r);
         }
 
-        template<class EXC> void parent_throw_if() { if(m_optional_error_pipe) (*m_optional_error_pipe).parent_throw_if<EXC>(); }
+        /// Call from post_fork_parent, after use_error_pipe from pre_fork_parent: waits until
+        /// the child exec'd or failed, so all its post_fork_child hooks took effect.
+        void wait_for_exec() { if(m_optional_error_pipe) (*m_optional_error_pipe).parent_read(); }
+
+        /// For exec(izs, ec): stores a failed fork or exec in the error_code, and leaves no failed
+        /// child behind.
+        BOOST_PROCESS_DECL void report_to_error_code(int fork_error);
+
+        /// The child's failure report, if the error pipe is in use and the child failed to exec.
+        const launch_report* parent_report() const
+        {
+            return (m_optional_error_pipe && (*m_optional_error_pipe).m_failed)? &(*m_optional_error_pipe).m_report : 0;
+        }
         
+        /// Appends the entries from add_child_env to the environment the initializers built.
+        BOOST_PROCESS_DECL void merge_env_additions();
+
+        BOOST_PROCESS_DECL bool replaced_by_addition(const char_type* entry) const;
+
+        struct indexed_post_fork_child
+        {
+            executor& m_e;
+
+            indexed_post_fork_child(executor& e) : m_e(e) { m_e.m_initializer = 0; }
+
+            template<class I> void operator()(const I& i) const { i.post_fork_child(m_e); ++m_e.m_initializer; }
+        };
+
         struct error_directed_pipe 
         {
             typedef int file_descriptor_type;
             
             mutable file_descriptor_type  m_read_end;
             mutable file_descriptor_type m_write_end;
-            mutable int                      m_errno;
+            mutable launch_report           m_report; // preallocated, so the child never allocates to report
+            mutable bool                    m_failed;
             
-             error_directed_pipe() : m_read_end(-1), m_write_end(-1), m_errno(0) {}
+             error_directed_pipe() : m_read_end(-1), m_write_end(-1), m_report(), m_failed(false) {}
             ~error_directed_pipe()
             {
                 if( m_read_end!=-1) close( m_read_end);
                 if(m_write_end!=-1) close(m_write_end);
             }
             
-            void pre_fork_parent(executor& e) const
-            {
-                {
-                    int pipe_fds[2] = {-1, -1};
-                    
-                    if(!::pipe(pipe_fds))
-                    {
-                        throw boost::system::system_error(boost::system::error_code(errno, boost::system::system_category()));
-                    }
-
-                     m_read_end = ensure_user_fd_index(pipe_fds[0]); if( m_read_end != pipe_fds[0]) close(pipe_fds[0]);
-                    m_write_end = ensure_user_fd_index(pipe_fds[1]); if(m_write_end != pipe_fds[1]) close(pipe_fds[1]);
-                }
-                
-                signal(SIGPIPE, SIG_IGN); // Who's to say this doesn't change elsewhere
-                
-                fcntl( m_read_end, F_SETFD, FD_CLOEXEC|fcntl( m_read_end, F_GETFD, 0)); 
-                fcntl(m_write_end, F_SETFD, FD_CLOEXEC|fcntl(m_write_end, F_GETFD, 0));
-                
-                e.set_in_use(m_write_end); 
-            }
+            BOOST_PROCESS_DECL void pre_fork_parent(executor& e) const;
             
             void post_fork_child(executor&) const
             {
                 close(m_read_end); m_read_end = -1;
             }
             
-            void child_throw(int err)
-            {
-                m_errno = err;
-                
-                ssize_t silence_compiler_warning = write(m_write_end, &m_errno, sizeof(m_errno));
-
-                close(m_write_end);
-                
-                _exit(127);    
-            }
-            
-            template<class EXC> void parent_throw_if()
-            {
-                if(-1 != m_write_end) { close(m_write_end); m_write_end = -1; }
-                
-                if(read(m_read_end, &m_errno, sizeof(m_errno) < 0))
-                {
-                    close(m_read_end);
-                    
-                    if(m_errno) throw EXC(boost::system::error_code(m_errno, boost::system::system_category()));
-                }
-                close(m_read_end);
-            }
+            BOOST_PROCESS_DECL void child_throw(int stage, int initializer, int err, const char* what, const char* detail);
             
-            static file_descriptor_type ensure_user_fd_index(file_descriptor_type fd)
-            {
-                return executor::parent_file_descriptor_map::ensure_user_fd_index(fd);;
-            }
+            /// Waits for the child to either exec (the pipe is closed on exec and read returns 0)
+            /// or to send its launch_report. Returns true if the child failed. Only the first
+            /// call waits, later ones return the same.
+            BOOST_PROCESS_DECL bool parent_read();
+
+            BOOST_PROCESS_DECL static file_descriptor_type ensure_user_fd_index(file_descriptor_type fd);
         };
         
         struct arg_ptrs
@@ -189,7 +259,9 @@ namespace boost { namespace process { namespace posix {
        
         struct parent_file_descriptor_map
         {
-            typedef std::set<file_descriptor_type> in_use_set_type;
+            typedef std::set<file_descriptor_type>                        in_use_set_type;
+            typedef std::pair<file_descriptor_type, file_descriptor_type> fd_mapping_type; // parent fd, child fd
+            typedef std::vector<fd_mapping_type>                          inherit_list_type;
         
             parent_file_descriptor_map()
             : m_dupd_parent_std_in (-1)
@@ -202,25 +274,50 @@ namespace boost { namespace process { namespace posix {
             void set_std_out(file_descriptor_type fd) { m_dupd_parent_std_out = ensure_user_fd_index(fd); }
             void set_std_err(file_descriptor_type fd) { m_dupd_parent_std_err = ensure_user_fd_index(fd); }
 
-            void set_child_std_fds()
-            {
-                dup2((-1!=m_dupd_parent_std_in )? m_dupd_parent_std_in  : open("/dev/zero", O_RDONLY),  STDIN_FILENO);
-                dup2((-1!=m_dupd_parent_std_out)? m_dupd_parent_std_out : open("/dev/null", O_WRONLY), STDOUT_FILENO);
-                dup2((-1!=m_dupd_parent_std_err)? m_dupd_parent_std_err : open("/dev/null", O_WRONLY), STDERR_FILENO);
-            }
+            BOOST_PROCESS_DECL void set_child_std_fds();
+
+            /// Moves inherited parent fds 0, 1 and 2 above all involved fds, so the child gets
+            /// the parent's std streams and not the ones set_child_std_fds puts there. Returns
+            /// false with errno set on failure. Call from child process, before set_child_std_fds.
+            BOOST_PROCESS_DECL bool park_std_sources();
             
             void set_in_use(file_descriptor_type fd) { m_in_use_set.insert(fd); }
-            
-            void close_unused_fds()
+
+            // call from parent process
+            BOOST_PROCESS_DECL void inherit(file_descriptor_type parent_fd, file_descriptor_type child_fd);
+
+            // call from parent process, so the child does not allocate
+            void prepare_child()
             {
-                 for(file_descriptor_type fd = min_user_file_descriptor() ; fd < max_file_descriptor() ; ++fd ) { close_unused_fd(fd); }
+                m_spared.reserve(m_in_use_set.size() + m_inherited.size() + 2);
             }
-            
-            void close_unused_fd(file_descriptor_type fd)
+
+            /// Moves every inherited fd to its child number with one dup2 each, parking a
+            /// source above all involved fds only to break a cycle like 3->4, 4->3. keep, the
+            /// executor's own fds, -1 where unused, are moved out of the way if they are child
+            /// numbers. Returns false with errno set on failure. Call from child process.
+            BOOST_PROCESS_DECL bool inherit_fds(file_descriptor_type* keep, std::size_t n_keep);
+
+            /// Closes every fd from 3 up, except the ones set in use, the inherited ones and keep,
+            /// so a child only gets that explicit list, whatever other threads opened meanwhile.
+            BOOST_PROCESS_DECL void close_unused_fds(const file_descriptor_type* keep = 0, std::size_t n_keep = 0);
+
+            bool is_child_fd(file_descriptor_type fd) const
+            {
+                for(inherit_list_type::const_iterator it = m_inherited.begin(); it != m_inherited.end(); ++it) if(it->second == fd) return true;
+                return false;
+            }
+
+            bool is_pending_parent_fd(file_descriptor_type fd) const
             {
-                 if(!m_in_use_set.count(fd)) { close(fd); }
+                for(inherit_list_type::const_iterator it = m_inherited.begin(); it != m_inherited.end(); ++it) if(it->first == fd) return true;
+                return false;
             }
 
+            /// Closes [first, last], or all from first up with last -1, with one close_range
+            /// where the kernel has it.
+            BOOST_PROCESS_DECL static void close_fds(file_descriptor_type first, file_descriptor_type last);
+
             static file_descriptor_type ensure_user_fd_index(file_descriptor_type fd)
             {
                 file_descriptor_type user_fd = fcntl(fd, F_DUPFD, min_user_file_descriptor());
@@ -228,23 +325,34 @@ namespace boost { namespace process { namespace posix {
                 return user_fd;
             }
             
-            static file_descriptor_type      max_file_descriptor() { return 1000; }
+            BOOST_PROCESS_DECL static file_descriptor_type max_file_descriptor();
+
             static file_descriptor_type min_user_file_descriptor() { return 3; /*BOOST_STATIC_ASSERT((STDIN_FILENO==0) && (STDOUT_FILENO==1) && (STDERR_FILENO==2))*/ }
 
             file_descriptor_type m_dupd_parent_std_in ;        
             file_descriptor_type m_dupd_parent_std_out;        
             file_descriptor_type m_dupd_parent_std_err;
             in_use_set_type      m_in_use_set;
+            inherit_list_type    m_inherited;
+            std::vector<file_descriptor_type> m_spared; // scratch space of close_unused_fds
         };
         
         typedef boost::optional<error_directed_pipe> optional_error_pipe_type;
 
         path                       m_exe;
+        file_descriptor_type       m_exe_fd;      // O_PATH fd of m_exe from paths, -1 to exec by path
+        int                      (*m_child_main)(const void*); // run instead of exec if set, see function
+        const void*                m_child_main_arg;
         arg_ptrs                   m_arg_ptrs;
         char_type**                m_env_vars_ptrs;
+        std::vector<char_type*>    m_env_additions;
+        std::vector<char_type*>    m_env_storage; // merged environment if there are additions
         parent_file_descriptor_map m_fd_map;
         pid_type                   m_pid;
         optional_error_pipe_type   m_optional_error_pipe;
+        int                        m_stage;       // launch_report::stage_type the child is in
+        int                        m_initializer; // index of the initializer running post_fork_child
+        boost::system::error_code* m_error_code;  // of exec(izs, ec), 0 to throw
         
     private:
                    executor(const executor&);
@@ -253,6 +361,8 @@ namespace boost { namespace process { namespace posix {
 
 }}}
 
-#undef BOOST_PROCESS_EXECUTOR_METHOD
+#if defined(BOOST_PROCESS_HEADER_ONLY)
+#   include <boost/process/posix/impl/executor.ipp>
+#endif
 
 #endif
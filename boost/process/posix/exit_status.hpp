@@ -0,0 +1,89 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_EXIT_STATUS_HPP
+#define BOOST_PROCESS_POSIX_EXIT_STATUS_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/config.hpp>
+
+#include <ostream>
+
+#include <signal.h>
+#include <sys/wait.h>
+
+namespace boost { namespace process { namespace posix {
+
+    /// How a child ended, as waitpid reports it. Holds just the status int, so it is
+    /// trivially copyable and an array of them is as compact as one of ints.
+    ///
+    /// It converts to that int for code written against the raw status, 0 still means the
+    /// child exited with code 0.
+    ///
+    /// \code
+    ///     bp::posix::exit_status s = monitor.join();
+    ///     if(s.signaled()) std::cerr << "killed by signal " << s.signal() << (s.core_dumped()? ", core dumped" : "");
+    ///     else if(s.code()) std::cerr << "failed with " << s.code();
+    /// \endcode
+    class exit_status
+    {
+    public:
+        BOOST_CONSTEXPR exit_status() : m_status(0) {}
+
+        BOOST_CONSTEXPR explicit exit_status(int status) : m_status(status) {}
+
+        /// From waitid, which reports the exit code or signal directly. Encoded the way
+        /// waitpid reports it on Linux and the BSDs.
+        explicit exit_status(const siginfo_t& info) : m_status(0)
+        {
+            switch(info.si_code)
+            {
+            case CLD_EXITED:    m_status = (info.si_status & 0xff) << 8;   break;
+            case CLD_KILLED:    m_status =  info.si_status & 0x7f;         break;
+            case CLD_DUMPED:    m_status = (info.si_status & 0x7f) | 0x80; break;
+            case CLD_CONTINUED: m_status = 0xffff;                         break;
+            default:            m_status = (info.si_status << 8) | 0x7f;   break; // stopped or trapped
+            }
+        }
+
+        BOOST_CONSTEXPR bool exited()   const { return WIFEXITED(m_status); }
+        BOOST_CONSTEXPR bool signaled() const { return WIFSIGNALED(m_status); }
+
+        /// Exit code, only meaningful if exited().
+        BOOST_CONSTEXPR int code()   const { return WEXITSTATUS(m_status); }
+
+        /// Terminating signal, only meaningful if signaled().
+        BOOST_CONSTEXPR int signal() const { return WTERMSIG(m_status); }
+
+#if defined(WCOREDUMP)
+        BOOST_CONSTEXPR bool core_dumped() const { return WIFSIGNALED(m_status) && WCOREDUMP(m_status); }
+#else
+        BOOST_CONSTEXPR bool core_dumped() const { return false; }
+#endif
+
+        /// Exited with code 0.
+        BOOST_CONSTEXPR bool success() const { return m_status == 0; }
+
+        /// The status as from waitpid.
+        BOOST_CONSTEXPR int native() const { return m_status; }
+
+        BOOST_CONSTEXPR operator int() const { return m_status; }
+
+    private:
+        int m_status;
+    };
+
+    inline std::ostream& operator<<(std::ostream& os, const exit_status& s)
+    {
+        if(s.exited())        os << "exit code " << s.code();
+        else if(s.signaled()) os << "signal " << s.signal() << (s.core_dumped()? " (core dumped)" : "");
+        else                  os << "status " << s.native();
+
+        return os;
+    }
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_EXIT_STATUS_HPP
@@ -10,8 +10,12 @@
 #define BOOST_PROCESS_POSIX_FILE_DESCRIPTOR_RAY_HPP
 
 #include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <cerrno>
 
 #include <fcntl.h>
+#include <unistd.h>
 
 namespace boost { namespace process { namespace posix {
 
@@ -20,20 +24,23 @@ namespace boost { namespace process { namespace posix {
         typedef boost::iostreams::file_descriptor_source source_type;
         typedef boost::iostreams::file_descriptor_sink     sink_type;
 
+        /// Both ends are close-on-exec, a child only gets the end handed to it by std_in_from,
+        /// std_out_to or std_err_to, even when other threads launch children meanwhile.
         file_descriptor_ray() : m_sink(), m_source() 
         {
             int pipe_fds[2] = {-1, -1};
 
-            if(!pipe(pipe_fds))
-            {
-                m_sink  .open(ensure_user_fd_index(pipe_fds[1]), boost::iostreams::close_handle);
-                m_source.open(ensure_user_fd_index(pipe_fds[0]), boost::iostreams::close_handle);
-            }
-            else
+#if defined(__linux__)
+            if(pipe2(pipe_fds, O_CLOEXEC))
+#else
+            if(pipe(pipe_fds))
+#endif
             {
-                // throw
+                throw boost::system::system_error(boost::system::error_code(errno, boost::system::system_category()));
             }
 
+            m_sink  .open(ensure_user_fd_index(pipe_fds[1]), boost::iostreams::close_handle);
+            m_source.open(ensure_user_fd_index(pipe_fds[0]), boost::iostreams::close_handle);
         }
         
         static int ensure_user_fd_index(int fd_index)
@@ -44,7 +51,7 @@ namespace boost { namespace process { namespace posix {
 
             const int user_fileno_begin = 3;
 
-            int user_fd_index = fcntl(fd_index, F_DUPFD, user_fileno_begin);
+            int user_fd_index = fcntl(fd_index, F_DUPFD_CLOEXEC, user_fileno_begin);
 
             close(fd_index);
 
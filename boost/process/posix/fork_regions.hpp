@@ -0,0 +1,204 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_FORK_REGIONS_HPP
+#define BOOST_PROCESS_POSIX_FORK_REGIONS_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/detail/helpers.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <cerrno>
+#include <cstddef>
+#include <vector>
+
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__GLIBC__)
+#   include <malloc.h>
+#endif
+
+namespace boost { namespace process { namespace posix {
+
+    /// Process wide registry of large memory regions that children never need.
+    ///
+    /// fork copies the page tables of every mapping, so with gigabytes of caches it takes
+    /// milliseconds, and a child touching a page before its exec copies that page too.
+    /// Regions registered here are left out of the children the executor forks: their
+    /// page tables are not copied at all.
+    ///
+    /// A region is page aligned inwards, the partial pages at its ends are still copied.
+    /// The child must not touch an excluded region between fork and exec, a post_fork_child
+    /// hook reading it gets SIGSEGV. Linux only (MADV_DONTFORK, 2.6.16, and MADV_WIPEONFORK,
+    /// 4.14); elsewhere registering does nothing.
+    ///
+    /// \code
+    ///     void* cache = mmap(0, cache_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    ///     bp::posix::fork_regions::add(cache, cache_size);
+    ///     bp::make_child(bp::paths(exe)); // forks without the cache's page tables
+    /// \endcode
+    class fork_regions
+    {
+    public:
+        enum policy_type
+        {
+            around_fork, ///< excluded by the executor for its forks only, two madvise calls per launch
+            never_fork,  ///< excluded from every fork from now on, including ones outside this library
+            wipe_on_fork ///< every fork gets the region zero filled, for anonymous private mappings
+        };
+
+        /// Registers [addr, addr + len). Throws a system_error if madvise rejects it, e.g. for
+        /// a file mapping with wipe_on_fork. Regions must not overlap.
+        static void add(void* addr, std::size_t len, policy_type policy = around_fork)
+        {
+            region r = aligned(addr, len, policy);
+            if(!r.m_len) return;
+
+            registry& g = instance();
+            pthread_mutex_lock(&g.m_mutex);
+
+            int error = 0;
+            if(policy != around_fork || g.m_forking) error = advise(r, false);
+            if(!error) g.m_regions.push_back(r);
+
+            pthread_mutex_unlock(&g.m_mutex);
+
+            if(error) throw boost::system::system_error(boost::system::error_code(error, boost::system::system_category()));
+        }
+
+        /// Unregisters the region added at addr, which forks copy again. Call before unmapping it.
+        static void remove(void* addr)
+        {
+            registry& g = instance();
+            pthread_mutex_lock(&g.m_mutex);
+
+            for(std::vector<region>::iterator it = g.m_regions.begin(); it != g.m_regions.end(); ++it)
+            {
+                if(it->m_addr != addr) continue;
+
+                if(it->m_policy != around_fork || g.m_forking) advise(*it, true);
+                g.m_regions.erase(it);
+                break;
+            }
+
+            pthread_mutex_unlock(&g.m_mutex);
+        }
+
+        /// Number of bytes registered, after alignment.
+        static std::size_t size()
+        {
+            registry& g = instance();
+            pthread_mutex_lock(&g.m_mutex);
+
+            std::size_t n = 0;
+            for(std::size_t i = 0; i < g.m_regions.size(); ++i) n += g.m_regions[i].m_len;
+
+            pthread_mutex_unlock(&g.m_mutex);
+            return n;
+        }
+
+        /// Has every fork of the executor first return freed heap memory to the system with
+        /// malloc_trim, so it is not copied either. Costs a walk over the heap per launch, so
+        /// it pays off only where the heap holds a lot of freed memory. glibc only.
+        static void trim_before_fork(bool on)
+        {
+            registry& g = instance();
+            pthread_mutex_lock(&g.m_mutex);
+            g.m_trim = on;
+            pthread_mutex_unlock(&g.m_mutex);
+        }
+
+        /// Call right before fork: excludes the around_fork regions. Forks of several threads
+        /// share one exclusion, it ends with the last of them.
+        static void before_fork()
+        {
+            registry& g = instance();
+            pthread_mutex_lock(&g.m_mutex);
+
+#if defined(__GLIBC__)
+            if(g.m_trim) malloc_trim(0);
+#endif
+            if(g.m_forking++ == 0)
+            {
+                for(std::size_t i = 0; i < g.m_regions.size(); ++i)
+                {
+                    if(g.m_regions[i].m_policy == around_fork) advise(g.m_regions[i], false);
+                }
+            }
+
+            pthread_mutex_unlock(&g.m_mutex);
+        }
+
+        /// Call in the parent once fork returned, whether it failed or not.
+        static void after_fork()
+        {
+            registry& g = instance();
+            pthread_mutex_lock(&g.m_mutex);
+
+            if(--g.m_forking == 0)
+            {
+                for(std::size_t i = 0; i < g.m_regions.size(); ++i)
+                {
+                    if(g.m_regions[i].m_policy == around_fork) advise(g.m_regions[i], true);
+                }
+            }
+
+            pthread_mutex_unlock(&g.m_mutex);
+        }
+
+    private:
+        struct region
+        {
+            void*       m_addr; // as given to add, to find it in remove
+            char*       m_begin;
+            std::size_t m_len;
+            policy_type m_policy;
+        };
+
+        struct registry
+        {
+            pthread_mutex_t     m_mutex;
+            std::vector<region> m_regions;
+            int                 m_forking; // forks between before_fork and after_fork
+            bool                m_trim;
+
+            registry() : m_regions(), m_forking(0), m_trim(false) { pthread_mutex_init(&m_mutex, 0); }
+        };
+
+        static registry& instance() { return detail::leaked_singleton<registry>::instance(); }
+
+        static region aligned(void* addr, std::size_t len, policy_type policy)
+        {
+            const std::size_t page  = std::size_t(sysconf(_SC_PAGESIZE));
+            const std::size_t first = (reinterpret_cast<std::size_t>(addr) + page - 1) & ~(page - 1);
+            const std::size_t last  = (reinterpret_cast<std::size_t>(addr) + len) & ~(page - 1);
+
+            region r = { addr, reinterpret_cast<char*>(first), (last > first)? last - first : 0, policy };
+            return r;
+        }
+
+        /// Returns an errno value on failure.
+        static int advise(const region& r, bool restore)
+        {
+#if defined(MADV_DONTFORK)
+            int advice = restore? MADV_DOFORK : MADV_DONTFORK;
+#   if defined(MADV_WIPEONFORK)
+            if(r.m_policy == wipe_on_fork) advice = restore? MADV_KEEPONFORK : MADV_WIPEONFORK;
+#   else
+            if(r.m_policy == wipe_on_fork) return EINVAL;
+#   endif
+            if(::madvise(r.m_begin, r.m_len, advice) == -1) return errno;
+#else
+            (void)r; (void)restore;
+#endif
+            return 0;
+        }
+    };
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_FORK_REGIONS_HPP
@@ -0,0 +1,481 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_IMPL_EXECUTOR_IPP
+#define BOOST_PROCESS_POSIX_IMPL_EXECUTOR_IPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/executor.hpp>
+#include <boost/process/posix/fork_regions.hpp>
+#include <boost/process/posix/launch_backend.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#if defined(__APPLE__)
+#   include <crt_externs.h> // _NSGetEnviron()
+#endif
+
+namespace boost { namespace process { namespace posix {
+
+    BOOST_PROCESS_DECL child executor::launch(const hooks& h)
+    {
+        h.m_pre_fork_parent(*this, h.m_initializers);
+
+        if(m_optional_error_pipe) (*m_optional_error_pipe).pre_fork_parent(*this);
+
+        merge_env_additions();
+        m_fd_map.prepare_child();
+
+        const bool shared = h.m_shares_child_memory && !m_child_main;
+        launch_backend::backend_type backend = launch_backend::choose(shared);
+
+        if(backend == launch_backend::fork_backend)
+        {
+            fork_regions::before_fork();
+            m_pid = fork();
+            const int error = errno;
+            if(m_pid != 0) fork_regions::after_fork();
+            errno = error;
+
+            // strict overcommit could not commit a copy of the parent, which the other backend does without
+            if(m_pid == -1 && error == ENOMEM && launch_backend::fallback_on_enomem(shared))
+            {
+                launch_backend::count_enomem_fallback();
+                backend = launch_backend::vfork_backend;
+            }
+        }
+        if(backend == launch_backend::vfork_backend) m_pid = vfork_child(h);
+
+        if(m_pid > 0) launch_backend::count_launch(backend);
+
+        const int fork_error = errno;
+
+        switch(m_pid)
+        {
+            case  0: post_fork_child(h); break;
+            default: h.m_post_fork_parent  (*this, h.m_initializers); break;
+            case -1: h.m_failed_fork_parent(*this, h.m_initializers); break;
+        }
+
+        if(m_error_code) report_to_error_code(fork_error);
+
+        return child(m_pid);
+    }
+
+    BOOST_PROCESS_DECL child executor::launch(const hooks& h, boost::system::error_code& ec)
+    {
+        ec.clear();
+        m_error_code = &ec;
+        use_error_pipe();
+
+        try
+        {
+            return launch(h);
+        }
+        catch(const boost::system::system_error& x) // from initializers' own setup, e.g. out of fds
+        {
+            ec = x.code();
+            report_to_error_code(0);
+
+            return child(m_pid);
+        }
+    }
+
+    BOOST_PROCESS_DECL void executor::post_fork_child(const hooks& h)
+    {
+        if(m_optional_error_pipe) (*m_optional_error_pipe).post_fork_child(*this);
+
+        m_stage = launch_report::post_fork_child;
+        h.m_post_fork_child(*this, h.m_initializers);
+        m_initializer = -1;
+
+        m_stage = launch_report::set_std_fds;
+        if(!m_fd_map.park_std_sources()) child_throw(errno, "fcntl");
+        m_fd_map.set_child_std_fds();
+
+        m_stage = launch_report::inherit_fds;
+        {
+            file_descriptor_type keep[2] = { m_optional_error_pipe? (*m_optional_error_pipe).m_write_end : -1, m_exe_fd };
+            bool moved = m_fd_map.inherit_fds(keep, 2);
+            if(m_optional_error_pipe) (*m_optional_error_pipe).m_write_end = keep[0];
+            m_exe_fd = keep[1];
+            if(!moved) child_throw(errno, "dup2");
+
+            m_stage = launch_report::close_fds;
+            m_fd_map.close_unused_fds(keep, 2);
+        }
+
+        m_stage = launch_report::exec;
+        if(m_child_main) run_child_main();
+
+#if defined(SYS_execveat) && defined(AT_EMPTY_PATH)
+        if(m_exe_fd != -1)
+        {
+            ::syscall(SYS_execveat, m_exe_fd, "", m_arg_ptrs.ptr(), m_env_vars_ptrs, AT_EMPTY_PATH); // doesn't return on success
+
+            // ENOENT for a script, its interpreter cannot open the close-on-exec fd
+            if(errno != ENOSYS && errno != ENOENT)
+            {
+                h.m_failed_exec_child(*this, h.m_initializers);
+
+                child_throw(errno, "execveat", m_exe.c_str());
+            }
+        }
+#endif
+        execve(m_exe.c_str(), m_arg_ptrs.ptr(), m_env_vars_ptrs); // doesn't return on success
+
+        h.m_failed_exec_child(*this, h.m_initializers);
+
+        child_throw(errno, "execve", m_exe.c_str()); // never return into the parent's code
+    }
+
+    BOOST_PROCESS_DECL void executor::run_child_main()
+    {
+        if(m_optional_error_pipe && (*m_optional_error_pipe).m_write_end != -1)
+        {
+            close((*m_optional_error_pipe).m_write_end);
+            (*m_optional_error_pipe).m_write_end = -1;
+        }
+        if(m_env_vars_ptrs)
+        {
+#if defined(__APPLE__)
+            *_NSGetEnviron() = m_env_vars_ptrs;
+#else
+            environ = m_env_vars_ptrs;
+#endif
+        }
+
+        _exit(m_child_main(m_child_main_arg));
+    }
+
+    struct executor::vfork_start
+    {
+        executor*    m_e;
+        const hooks* m_hooks;
+        sigset_t     m_mask; // of the launching thread, the child's from its hooks on
+
+        static int run(void* self)
+        {
+            const vfork_start& s = *static_cast<const vfork_start*>(self);
+
+            for(int sig = 1; sig < NSIG; ++sig)
+            {
+                struct sigaction a;
+                if(sigaction(sig, 0, &a) == -1 || a.sa_handler == SIG_DFL || a.sa_handler == SIG_IGN) continue;
+
+                a.sa_handler = SIG_DFL;
+                a.sa_flags   = 0;
+                sigaction(sig, &a, 0);
+            }
+            pthread_sigmask(SIG_SETMASK, &s.m_mask, 0);
+
+            s.m_e->post_fork_child(*s.m_hooks); // execs or _exits
+            return 127;
+        }
+    };
+
+    BOOST_PROCESS_DECL executor::pid_type executor::vfork_child(const hooks& h)
+    {
+#if defined(__linux__)
+        const std::size_t stack_size = 256 * 1024;
+        void* stack = mmap(0, stack_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_STACK, -1, 0);
+        if(stack == MAP_FAILED) return -1;
+
+        // the child closes and moves its copies of the error pipe's ends in this very object
+        file_descriptor_type pipe_ends[2] = { -1, -1 };
+        if(m_optional_error_pipe)
+        {
+            pipe_ends[0] = (*m_optional_error_pipe).m_read_end;
+            pipe_ends[1] = (*m_optional_error_pipe).m_write_end;
+        }
+
+        vfork_start s;
+        s.m_e     = this;
+        s.m_hooks = &h;
+
+        sigset_t all;
+        sigfillset(&all);
+        pthread_sigmask(SIG_SETMASK, &all, &s.m_mask);
+
+        pid_type pid = ::clone(&vfork_start::run, static_cast<char*>(stack) + stack_size, CLONE_VM|CLONE_VFORK|SIGCHLD, &s);
+        const int error = errno;
+
+        pthread_sigmask(SIG_SETMASK, &s.m_mask, 0);
+        munmap(stack, stack_size);
+
+        if(m_optional_error_pipe)
+        {
+            (*m_optional_error_pipe).m_read_end  = pipe_ends[0];
+            (*m_optional_error_pipe).m_write_end = pipe_ends[1];
+        }
+        m_stage       = launch_report::no_stage;
+        m_initializer = -1;
+
+        errno = error;
+        return pid;
+#else
+        (void)h;
+        errno = ENOSYS;
+        return -1;
+#endif
+    }
+
+    BOOST_PROCESS_DECL void executor::report_to_error_code(int fork_error)
+    {
+        boost::system::error_code& ec = *m_error_code;
+
+        if(m_pid == -1)
+        {
+            if(!ec) ec.assign(fork_error? fork_error : EAGAIN, boost::system::system_category());
+            return;
+        }
+
+        if(!ec && m_optional_error_pipe && (*m_optional_error_pipe).parent_read())
+        {
+            ec.assign((*m_optional_error_pipe).m_report.m_errno, boost::system::system_category());
+        }
+        if(!ec) return;
+
+        ::kill(m_pid, SIGKILL); // has exited already unless a hook failed after its exec
+        while(::waitpid(m_pid, 0, 0) == -1 && errno == EINTR) {}
+        m_pid = -1;
+    }
+
+    BOOST_PROCESS_DECL void executor::merge_env_additions()
+    {
+        if(m_env_additions.empty()) return;
+
+        m_env_storage.clear();
+        for(char_type** p = m_env_vars_ptrs; p && *p; ++p)
+        {
+            if(!replaced_by_addition(*p)) m_env_storage.push_back(*p);
+        }
+        m_env_storage.insert(m_env_storage.end(), m_env_additions.begin(), m_env_additions.end());
+        m_env_storage.push_back(0);
+
+        m_env_vars_ptrs = &m_env_storage[0];
+    }
+
+    BOOST_PROCESS_DECL bool executor::replaced_by_addition(const char_type* entry) const
+    {
+        for(std::size_t i = 0; i < m_env_additions.size(); ++i)
+        {
+            const char_type* a = m_env_additions[i];
+            const char_type* e = entry;
+            while(*a && *a != '=' && *a == *e) { ++a; ++e; }
+            if(*a == '=' && *e == '=') return true;
+        }
+        return false;
+    }
+
+    BOOST_PROCESS_DECL void executor::error_directed_pipe::pre_fork_parent(executor& e) const
+    {
+        int pipe_fds[2] = {-1, -1};
+
+        // close-on-exec from the start, so children launched by other threads in the
+        // meantime never hold the write end past their exec
+#if defined(__linux__)
+        if(::pipe2(pipe_fds, O_CLOEXEC) == -1)
+#else
+        if(::pipe(pipe_fds) == -1)
+#endif
+        {
+            throw boost::system::system_error(boost::system::error_code(errno, boost::system::system_category()));
+        }
+
+         m_read_end = ensure_user_fd_index(pipe_fds[0]); close(pipe_fds[0]);
+        m_write_end = ensure_user_fd_index(pipe_fds[1]); close(pipe_fds[1]);
+
+        // no global SIGPIPE disposition: only the child writes, and the parent
+        // keeps the read end open until it read the report or EOF
+
+        e.set_in_use(m_write_end);
+    }
+
+    BOOST_PROCESS_DECL void executor::error_directed_pipe::child_throw(int stage, int initializer, int err, const char* what, const char* detail)
+    {
+        m_report.assign(stage, initializer, err, what, detail);
+
+        ssize_t silence_compiler_warning = write(m_write_end, &m_report, sizeof(m_report));
+        (void)silence_compiler_warning;
+
+        close(m_write_end);
+
+        _exit(127);
+    }
+
+    BOOST_PROCESS_DECL bool executor::error_directed_pipe::parent_read()
+    {
+        if(-1 == m_read_end) return m_failed;
+
+        if(-1 != m_write_end) { close(m_write_end); m_write_end = -1; }
+
+        ssize_t n = 0;
+
+        do
+        {
+            n = read(m_read_end, &m_report, sizeof(m_report));
+        }
+        while(n == -1 && errno == EINTR);
+
+        close(m_read_end); m_read_end = -1;
+
+        m_failed = (n == sizeof(m_report));
+
+        return m_failed;
+    }
+
+    BOOST_PROCESS_DECL executor::file_descriptor_type executor::error_directed_pipe::ensure_user_fd_index(file_descriptor_type fd)
+    {
+        return fcntl(fd, F_DUPFD_CLOEXEC, executor::parent_file_descriptor_map::min_user_file_descriptor());
+    }
+
+    BOOST_PROCESS_DECL void executor::parent_file_descriptor_map::set_child_std_fds()
+    {
+        dup2((-1!=m_dupd_parent_std_in )? m_dupd_parent_std_in  : open("/dev/zero", O_RDONLY),  STDIN_FILENO);
+        dup2((-1!=m_dupd_parent_std_out)? m_dupd_parent_std_out : open("/dev/null", O_WRONLY), STDOUT_FILENO);
+        dup2((-1!=m_dupd_parent_std_err)? m_dupd_parent_std_err : open("/dev/null", O_WRONLY), STDERR_FILENO);
+    }
+
+    BOOST_PROCESS_DECL bool executor::parent_file_descriptor_map::park_std_sources()
+    {
+        file_descriptor_type high = min_user_file_descriptor();
+        for(inherit_list_type::const_iterator it = m_inherited.begin(); it != m_inherited.end(); ++it)
+        {
+            high = (std::max)(high, (std::max)(it->first, it->second) + 1);
+        }
+
+        for(inherit_list_type::iterator it = m_inherited.begin(); it != m_inherited.end(); ++it)
+        {
+            if(it->first > STDERR_FILENO) continue;
+
+            file_descriptor_type std_source = it->first;
+            file_descriptor_type parked = fcntl(std_source, F_DUPFD_CLOEXEC, high);
+            if(parked == -1) return false;
+            high = parked + 1;
+
+            for(inherit_list_type::iterator same = it; same != m_inherited.end(); ++same) if(same->first == std_source) same->first = parked;
+        }
+        return true;
+    }
+
+    BOOST_PROCESS_DECL void executor::parent_file_descriptor_map::inherit(file_descriptor_type parent_fd, file_descriptor_type child_fd)
+    {
+        for(inherit_list_type::const_iterator it = m_inherited.begin(); it != m_inherited.end(); ++it)
+        {
+            if(it->second == child_fd) throw std::invalid_argument("inherit_fds: child fd " + boost::lexical_cast<std::string>(child_fd) + " is inherited twice");
+        }
+        m_inherited.push_back(fd_mapping_type(parent_fd, child_fd));
+    }
+
+    BOOST_PROCESS_DECL bool executor::parent_file_descriptor_map::inherit_fds(file_descriptor_type* keep, std::size_t n_keep)
+    {
+        std::size_t pending = m_inherited.size();
+        if(!pending) return true;
+
+        file_descriptor_type high = min_user_file_descriptor();
+        for(inherit_list_type::const_iterator it = m_inherited.begin(); it != m_inherited.end(); ++it)
+        {
+            high = (std::max)(high, (std::max)(it->first, it->second) + 1);
+        }
+        for(std::size_t k = 0; k < n_keep; ++k) high = (std::max)(high, keep[k] + 1);
+
+        for(std::size_t k = 0; k < n_keep; ++k)
+        {
+            if(keep[k] == -1 || !is_child_fd(keep[k])) continue;
+
+            if((keep[k] = fcntl(keep[k], F_DUPFD_CLOEXEC, high)) == -1) return false;
+            high = keep[k] + 1;
+        }
+
+        // a done mapping has parent fd -1
+        for(inherit_list_type::iterator it = m_inherited.begin(); it != m_inherited.end(); ++it)
+        {
+            if(it->first != it->second) continue;
+
+            if(fcntl(it->first, F_SETFD, 0) == -1) return false; // dup2 would clear close-on-exec
+            it->first = -1; --pending;
+        }
+
+        while(pending)
+        {
+            bool progressed = false;
+
+            for(inherit_list_type::iterator it = m_inherited.begin(); it != m_inherited.end(); ++it)
+            {
+                if(it->first == -1 || is_pending_parent_fd(it->second)) continue;
+
+                if(dup2(it->first, it->second) == -1) return false;
+                it->first = -1; --pending; progressed = true;
+            }
+
+            if(!progressed)
+            {
+                // only cycles are left
+                inherit_list_type::iterator it = m_inherited.begin();
+                while(it->first == -1) ++it;
+
+                file_descriptor_type cycled = it->first;
+                file_descriptor_type parked = fcntl(cycled, F_DUPFD_CLOEXEC, high);
+                if(parked == -1) return false;
+                high = parked + 1;
+
+                for(; it != m_inherited.end(); ++it) if(it->first == cycled) it->first = parked;
+            }
+        }
+        return true;
+    }
+
+    BOOST_PROCESS_DECL void executor::parent_file_descriptor_map::close_unused_fds(const file_descriptor_type* keep, std::size_t n_keep)
+    {
+        m_spared.assign(m_in_use_set.begin(), m_in_use_set.end());
+        for(inherit_list_type::const_iterator it = m_inherited.begin(); it != m_inherited.end(); ++it) m_spared.push_back(it->second);
+        for(std::size_t k = 0; k < n_keep; ++k) if(keep[k] != -1) m_spared.push_back(keep[k]);
+        std::sort(m_spared.begin(), m_spared.end());
+
+        file_descriptor_type first = min_user_file_descriptor();
+
+        for(std::vector<file_descriptor_type>::const_iterator it = m_spared.begin(); it != m_spared.end(); ++it)
+        {
+            if(*it < first) continue;
+
+            close_fds(first, *it - 1);
+            first = *it + 1;
+        }
+        close_fds(first, -1);
+    }
+
+    BOOST_PROCESS_DECL void executor::parent_file_descriptor_map::close_fds(file_descriptor_type first, file_descriptor_type last)
+    {
+        if(last != -1 && first > last) return;
+#if defined(SYS_close_range)
+        if(::syscall(SYS_close_range, (unsigned int)first, (last == -1)? ~0U : (unsigned int)last, 0) == 0) return;
+#endif
+        if(last == -1) last = max_file_descriptor();
+
+        for(file_descriptor_type fd = first; fd <= last; ++fd) close(fd);
+    }
+
+    BOOST_PROCESS_DECL executor::file_descriptor_type executor::parent_file_descriptor_map::max_file_descriptor()
+    {
+        rlimit l;
+        if(getrlimit(RLIMIT_NOFILE, &l) == -1 || l.rlim_cur == RLIM_INFINITY || l.rlim_cur > 65536) return 65535;
+
+        return file_descriptor_type(l.rlim_cur) - 1;
+    }
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_IMPL_EXECUTOR_IPP
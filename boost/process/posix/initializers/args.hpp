@@ -25,6 +25,7 @@ namespace boost { namespace process { namespace posix {
     {
         // multiple arg initializers can be combined in one sequence.
         typedef initializer_combination::ignore combination_category;
+        typedef child_memory::shared child_memory_category;
 
         typedef boost::filesystem::path path;
         typedef std::vector<char>       chars;
@@ -68,6 +69,10 @@ namespace boost { namespace process { namespace posix {
 
     struct args : public initializer 
     {
+        // multiple args initializers can be combined in one sequence.
+        typedef initializer_combination::ignore combination_category;
+        typedef child_memory::shared child_memory_category;
+
         typedef std::vector<arg> args_type;
         
         args_type m_args;
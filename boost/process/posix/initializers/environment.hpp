@@ -16,6 +16,7 @@
 
 #include <boost/process/config.hpp>
 #include <boost/process/posix/initializers/initializer.hpp>
+#include <boost/process/detail/flat_map.hpp>
 
 #include <boost/filesystem/path.hpp>
 #include <boost/lexical_cast.hpp>
@@ -24,7 +25,11 @@
 #	include <crt_externs.h> // _NSGetEnviron()
 #endif
 
-#include <map>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <vector>
 
 namespace boost { namespace process { namespace posix {
 
@@ -107,22 +112,31 @@ namespace boost { namespace process { namespace posix {
          * Neither POSIX nor Windows systems support a variable with no name.
          *
          * It is worthy to note that the environment is sorted alphabetically.
-         * This is provided for-free by the map container used to implement this
-         * type, and this behavior is required by Windows systems.
+         * This is provided for-free by the sorted flat container used to implement
+         * this type, and this behavior is required by Windows systems.
+         *
+         * A derived environment is an overlay: the parent's environ is not
+         * copied, m_environment only holds the variables that were set and
+         * m_unset the parent variables that were removed. Both are merged with
+         * the parent's environ when the child's envp is built at launch time.
          */
-        typedef std::map<std::string, std::string> environment_type;
+        typedef process::detail::flat_map<std::string, std::string> environment_type;
+        typedef std::set<std::string>              name_set_type;
         typedef boost::filesystem::path path;
 
         // multiple environment initializers should not be combined in one sequence.
         typedef initializer_combination::exclusive combination_category;
+        typedef child_memory::shared child_memory_category;
 
         environment_type m_environment;
+        name_set_type    m_unset;
+        bool             m_derived;
 
-        environment()                   : m_environment() { initialize_environment(); }
-        environment(derive_environment) : m_environment() { initialize_environment(); }
-        environment(clean_environment)  : m_environment() { }
-        template<typename T>               environment(const T& namevalue)              : m_environment() { add(env(namevalue)); }
-        template<typename T1, typename T2> environment(const T1& name, const T2& value) : m_environment() { add(env(name, value)); }
+        environment()                   : m_environment(), m_unset(), m_derived(false) { initialize_environment(); }
+        environment(derive_environment) : m_environment(), m_unset(), m_derived(false) { initialize_environment(); }
+        environment(clean_environment)  : m_environment(), m_unset(), m_derived(false) { }
+        template<typename T>               environment(const T& namevalue)              : m_environment(), m_unset(), m_derived(false) { add(env(namevalue)); }
+        template<typename T1, typename T2> environment(const T1& name, const T2& value) : m_environment(), m_unset(), m_derived(false) { add(env(name, value)); }
 
         environment& operator()(derive_environment)
         {
@@ -132,6 +146,8 @@ namespace boost { namespace process { namespace posix {
         environment& operator()(clean_environment)
         {
             m_environment.clear();
+            m_unset.clear();
+            m_derived = false;
             return *this;
         }
         environment& operator()(const env& e)
@@ -147,11 +163,13 @@ namespace boost { namespace process { namespace posix {
 
         void add(const env& e)
         {
+            m_unset.erase(e.m_namevalue.first);
+
             environment_type::iterator lb = m_environment.lower_bound(e.m_namevalue.first);
             if ((lb != m_environment.end()) && !(m_environment.key_comp()(e.m_namevalue.first, lb->first)))
             {
                 // setting a new value overwrites the existing one
-                m_environment[e.m_namevalue.first] = e.m_namevalue.second;
+                lb->second = e.m_namevalue.second;
             }
             else
             {
@@ -159,66 +177,126 @@ namespace boost { namespace process { namespace posix {
             }
         }
 
+        /// removes a variable, including one inherited from the parent
+        void unset(const std::string& varname)
+        {
+            m_environment.erase(varname);
+
+            if (m_derived && parent_value(varname)) m_unset.insert(varname);
+        }
+
+        /// derives from the parent's environment without copying it, values of
+        /// the parent take precedence over the variables set so far
         void initialize_environment()
         {
+            for (environment_type::iterator it = m_environment.begin(); it != m_environment.end(); )
+            {
+                if (parent_value(it->first)) it = m_environment.erase(it); else ++it;
+            }
+            m_unset.clear();
+            m_derived = true;
+        }
+
+        static char** parent_environ()
+        {
 #if defined(__APPLE__)
-            char **ppenv = *_NSGetEnviron();
+            return *_NSGetEnviron();
 #else
-            char **ppenv = environ;
+            return environ;
 #endif
-            while (*ppenv)
+        }
+
+        /// the parent's value of varname, 0 if it is not set
+        static const char* parent_value(const std::string& varname)
+        {
+            return getenv(varname.c_str());
+        }
+
+        bool contains(const std::string& varname) const
+        {
+            return m_environment.count(varname) || (m_derived && !m_unset.count(varname) && parent_value(varname));
+        }
+
+        /// the entry of varname in m_environment, initialized from the parent if inherited
+        std::string& value_of(const std::string& varname)
+        {
+            environment_type::iterator it = m_environment.find(varname);
+            if (it == m_environment.end())
             {
-                std::string namevalue = *ppenv;
-                add(env(namevalue));
-                ++ppenv;
+                const char* v = (m_derived && !m_unset.count(varname))? parent_value(varname) : 0;
+
+                m_unset.erase(varname);
+                it = m_environment.insert(std::make_pair(varname, std::string(v? v : ""))).first;
             }
+            return it->second;
         }
 
         void append_var(const std::string& varname, const char* value)
         {
-            m_environment[varname] += value;
+            value_of(varname) += value;
         }
         void append_var(const std::string& varname, const std::string& value)
         {
-            m_environment[varname] += value;
+            value_of(varname) += value;
         }
         void append_var(const std::string& varname, const path& p)
         {
-            if (0 == m_environment.count(varname))
+            if (!contains(varname))
             {
-                m_environment[varname] = p.native();
+                value_of(varname) = p.native();
             }
             else
             {
-                m_environment[varname] += ':' + p.native();
+                value_of(varname) += ':' + p.native();
             }
         }
 
         void prepend_var(const std::string& varname, const char* value)
         {
-            m_environment[varname] = value + m_environment[varname];
+            std::string& v = value_of(varname);
+            v = value + v;
         }
         void prepend_var(const std::string& varname, const std::string& value)
         {
-            m_environment[varname] = value + m_environment[varname];
+            std::string& v = value_of(varname);
+            v = value + v;
         }
         void prepend_var(const std::string& varname, const path& p)
         {
-            if (0 == m_environment.count(varname))
+            if (!contains(varname))
             {
-                m_environment[varname] = p.native();
+                value_of(varname) = p.native();
             }
             else
             {
-                m_environment[varname] =  p.native() + ':' + m_environment[varname];
+                std::string& v = value_of(varname);
+                v = p.native() + ':' + v;
             }
         }
 
-        bool operator==(const environment& rhs) const
+        /// The complete, sorted environment the child will see.
+        environment_type merged() const
         {
-            return m_environment == rhs.m_environment;
+            environment_type all = m_environment;
+            if (m_derived)
+            {
+                std::vector<env::namevalue> inherited;
+                for (char** ppenv = parent_environ(); *ppenv; ++ppenv)
+                {
+                    env e = env(std::string(*ppenv));
+                    if (!m_unset.count(e.m_namevalue.first)) inherited.push_back(e.m_namevalue);
+                }
+                all.insert(inherited.begin(), inherited.end()); // the overlay's values win
+            }
+            return all;
         }
 
+        bool operator==(const environment& rhs) const
+        {
+            if (!m_derived && !rhs.m_derived) return m_environment == rhs.m_environment;
+
+            return merged() == rhs.merged();
+        }
 
         /**
          * Converts an environment to a char** table as used by execve().
@@ -238,31 +316,110 @@ namespace boost { namespace process { namespace posix {
          */
         inline char** environment_to_envp() const
         {
-            char **envp = new char*[m_environment.size() + 1];
-            environment_type::size_type i = 0;
-            for (environment_type::const_iterator it = m_environment.begin(); it != m_environment.end(); ++it)
+            build_envp();
+
+            char **envp = new char*[m_envp.size()];
+            for (std::size_t i = 0; i + 1 < m_envp.size(); ++i)
             {
-                std::string s = it->first + "=" + it->second;
-                envp[i] = new char[s.size() + 1];
-                std::strncpy(envp[i], s.c_str(), s.size() + 1);
-                ++i;
+                std::size_t n = std::strlen(m_envp[i]) + 1;
+                envp[i] = new char[n];
+                std::memcpy(envp[i], m_envp[i], n);
             }
-            envp[i] = 0;
+            envp[m_envp.size() - 1] = 0;
             return envp;
         }
 
+        /// Orders a variable name given as [first, last) against a name in the overlay
+        /// without building a std::string for each entry of the parent's environ.
+        struct name_less
+        {
+            static int compare(const char* first, const char* last, const std::string& name)
+            {
+                std::size_t n = last - first;
+                int r = name.compare(0, n, first, n);
+                return (r != 0)? -r : ((name.size() > n)? -1 : 0);
+            }
+            typedef std::pair<const char*, const char*> range;
+
+            bool operator()(const std::string* name, const range& r) const { return compare(r.first, r.second, *name) > 0; }
+            bool operator()(const range& r, const std::string* name) const { return compare(r.first, r.second, *name) < 0; }
+        };
+
+        /// Builds the child's envp in m_envp in one pass over the parent's environ. Entries
+        /// inherited from the parent point into the parent's environ, the overlay's
+        /// entries into m_envp_chars.
+        void build_envp() const
+        {
+            m_envp.clear();
+            m_envp_chars.clear();
+
+            std::size_t chars = 0;
+            for (environment_type::const_iterator it = m_environment.begin(); it != m_environment.end(); ++it)
+            {
+                chars += it->first.size() + it->second.size() + 2;
+            }
+            m_envp_chars.reserve(chars);
+
+            if (m_derived)
+            {
+                // every name in m_environment or m_unset hides the parent's entry
+                std::vector<const std::string*> hidden;
+                hidden.reserve(m_environment.size() + m_unset.size());
+                for (environment_type::const_iterator it = m_environment.begin(); it != m_environment.end(); ++it) hidden.push_back(&it->first);
+                for (name_set_type   ::const_iterator it = m_unset      .begin(); it != m_unset      .end(); ++it) hidden.push_back(&*it);
+                std::inplace_merge(hidden.begin(), hidden.begin() + m_environment.size(), hidden.end(), indirect_less());
+
+                for (char** ppenv = parent_environ(); *ppenv; ++ppenv)
+                {
+                    const char* eq = std::strchr(*ppenv, '=');
+                    name_less::range name(*ppenv, eq? eq : *ppenv + std::strlen(*ppenv));
+
+                    if (hidden.empty() || !std::binary_search(hidden.begin(), hidden.end(), name, name_less()))
+                    {
+                        m_envp.push_back(*ppenv);
+                    }
+                }
+            }
+
+            for (environment_type::const_iterator it = m_environment.begin(); it != m_environment.end(); ++it)
+            {
+                m_envp_chars.insert(m_envp_chars.end(), it->first .begin(), it->first .end()); m_envp_chars.push_back('=');
+                m_envp_chars.insert(m_envp_chars.end(), it->second.begin(), it->second.end()); m_envp_chars.push_back(0);
+            }
+            std::size_t offset = 0;
+            for (environment_type::const_iterator it = m_environment.begin(); it != m_environment.end(); ++it)
+            {
+                m_envp.push_back(&m_envp_chars[offset]);
+                offset += it->first.size() + it->second.size() + 2;
+            }
+            m_envp.push_back(0);
+        }
+
+        struct indirect_less
+        {
+            bool operator()(const std::string* l, const std::string* r) const { return *l < *r; }
+        };
+
         template<class Executor> void pre_fork_parent(Executor& e) const
         {
-            e.m_env_vars_ptrs = environment_to_envp();
+            build_envp();
+
+            e.m_env_vars_ptrs = &m_envp[0];
         }
 
+        // storage of the envp handed to execve, owned by the initializer which outlives the launch
+        mutable std::vector<char*> m_envp;
+        mutable std::vector<char > m_envp_chars;
+
         friend std::ostream& operator<<(std::ostream&, const environment&);
     };
 
     inline std::ostream& operator<< (std::ostream& os, const environment& a)
     {
-        environment::environment_type::const_iterator itBegin = a.m_environment.begin();
-        environment::environment_type::const_iterator itEnd = a.m_environment.end();
+        const environment::environment_type all = a.m_derived? a.merged() : environment::environment_type();
+        const environment::environment_type& vars = a.m_derived? all : a.m_environment;
+        environment::environment_type::const_iterator itBegin = vars.begin();
+        environment::environment_type::const_iterator itEnd = vars.end();
         if(itBegin != itEnd)
         {
             os << itBegin->first << '=' << itBegin->second;
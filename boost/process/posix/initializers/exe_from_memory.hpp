@@ -0,0 +1,151 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_INITIALIZER_EXE_FROM_MEMORY_HPP
+#define BOOST_PROCESS_POSIX_INITIALIZER_EXE_FROM_MEMORY_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/detail/helpers.hpp>
+#include <boost/process/posix/initializers/initializer.hpp>
+#include <boost/process/posix/initializers/std_io_memory.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <cerrno>
+#include <string>
+#include <vector>
+
+#if !defined(__linux__)
+#   error "exe_from_memory requires Linux (memfd_create, execveat)"
+#endif
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+namespace boost { namespace process { namespace posix {
+
+    /// Runs an executable image held in memory, e.g. a helper binary embedded in the
+    /// application, instead of a file named with paths. Use one or the other.
+    ///
+    /// The first exe_from_memory of an image copies it into a sealed memfd, which the process
+    /// keeps for every later one of the same image, found by its address and size. The image
+    /// therefore has to stay unchanged as long as the process runs, as a static array does.
+    /// Launches exec the memfd with execveat, no file system is touched. argv[0] is name,
+    /// the child runs in the parent's working directory.
+    ///
+    /// Only binaries can run this way: a script's interpreter cannot open the close-on-exec
+    /// memfd, the child starts but the interpreter fails.
+    ///
+    /// \code
+    ///     extern const unsigned char helper[]; extern const std::size_t helper_size; // from xxd -i
+    ///     bp::make_child(bp::posix::exe_from_memory(helper, helper_size, "helper"), bp::args("--check"));
+    /// \endcode
+    struct exe_from_memory : public initializer
+    {
+        // multiple executables cannot be combined in one sequence.
+        typedef initializer_combination::exclusive combination_category;
+        typedef child_memory::shared child_memory_category;
+
+        exe_from_memory(const void* image, std::size_t size, const std::string& name = "exe")
+        : m_image(image), m_size(size), m_name(name.begin(), name.end()), m_fd(-1), m_exe()
+        {
+            m_name.push_back(0);
+
+            m_fd  = image_fd(m_image, m_size, &m_name[0]);
+            m_exe = "/proc/self/fd/" + boost::lexical_cast<std::string>(m_fd);
+        }
+
+        template<class Executor> void pre_fork_parent(Executor& e) const
+        {
+            e.m_exe    = m_exe; // for reports, and the exec by path where execveat is missing
+            e.m_exe_fd = m_fd;
+            e.m_arg_ptrs.assign_app(&m_name[0]);
+        }
+
+        /// Number of images copied into memfds so far.
+        static std::size_t cached_images()
+        {
+            cache& c = instance();
+            pthread_mutex_lock(&c.m_mutex);
+            std::size_t n = c.m_entries.size();
+            pthread_mutex_unlock(&c.m_mutex);
+
+            return n;
+        }
+
+        const void*               m_image;
+        std::size_t               m_size;
+        mutable std::vector<char> m_name;
+        int                       m_fd;  // the cached memfd
+        std::string               m_exe;
+
+    private:
+        struct entry
+        {
+            const void* m_image;
+            std::size_t m_size;
+            int         m_fd;
+        };
+
+        struct cache
+        {
+            pthread_mutex_t    m_mutex;
+            std::vector<entry> m_entries;
+
+            cache() : m_entries() { pthread_mutex_init(&m_mutex, 0); }
+        };
+
+        // nor are the memfds closed: children may be launched until exit
+        static cache& instance() { return detail::leaked_singleton<cache>::instance(); }
+
+        /// The memfd holding the image, created on first use.
+        static int image_fd(const void* image, std::size_t size, const char* name)
+        {
+            cache& c = instance();
+            pthread_mutex_lock(&c.m_mutex);
+
+            for(std::size_t i = 0; i < c.m_entries.size(); ++i)
+            {
+                if(c.m_entries[i].m_image == image && c.m_entries[i].m_size == size)
+                {
+                    int fd = c.m_entries[i].m_fd;
+                    pthread_mutex_unlock(&c.m_mutex);
+                    return fd;
+                }
+            }
+
+            int fd = -1;
+            try
+            {
+                memory_file f(name, true);
+                f.write_all(static_cast<const char*>(image), size);
+                f.seal();
+
+                // a read-only description to exec, older kernels refuse files open for writing
+                const std::string proc_path = "/proc/self/fd/" + boost::lexical_cast<std::string>(f.handle());
+
+                fd = ::open(proc_path.c_str(), O_RDONLY|O_CLOEXEC);
+                if(fd == -1) fd = ::fcntl(f.handle(), F_DUPFD_CLOEXEC, 3);
+                if(fd == -1) throw boost::system::system_error(boost::system::error_code(errno, boost::system::system_category()));
+
+                entry e = { image, size, fd };
+                c.m_entries.push_back(e);
+            }
+            catch(...)
+            {
+                if(fd != -1) close(fd);
+                pthread_mutex_unlock(&c.m_mutex);
+                throw;
+            }
+
+            pthread_mutex_unlock(&c.m_mutex);
+            return fd;
+        }
+    };
+
+}}}
+
+#endif
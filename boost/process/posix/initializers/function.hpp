@@ -0,0 +1,106 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_INITIALIZER_FUNCTION_HPP
+#define BOOST_PROCESS_POSIX_INITIALIZER_FUNCTION_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/initializers/initializer.hpp>
+#include <boost/function.hpp>
+#include <boost/type_traits/is_void.hpp>
+#include <boost/utility/result_of.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <iostream>
+
+#include <unistd.h>
+
+namespace boost { namespace process { namespace posix {
+
+    /// Runs a callable in the forked child instead of an executable, then _exits with its
+    /// return value, 0 for one returning void. The child-side initializers apply as usual,
+    /// std streams, inherited fds, environment and process group, but there is no exec: no
+    /// dynamic loading and no start up of a new program, only the fork.
+    ///
+    /// The child is a copy of the parent as it was at the fork, with only the launching
+    /// thread. Locks other threads held stay locked in the child, so the callable should
+    /// stick to its own data, the heap and I/O on fds. Memory registered with fork_regions
+    /// is missing. Pending output of the parent's stdio and std::cout is flushed before the
+    /// fork, the child's own when the callable returns. An exception escaping it is written
+    /// to stderr and the child exits with 1.
+    ///
+    /// \code
+    ///     bp::file_descriptor_ray out;
+    ///     bp::monitor m(bp::make_child(bp::posix::function(boost::bind(&checksum, path)), bp::std_out_to(out)));
+    /// \endcode
+    struct function : public initializer
+    {
+        // a child runs one program
+        typedef initializer_combination::exclusive combination_category;
+
+        typedef boost::function<int ()> callable_type;
+
+        template<class F> explicit function(F f) : m_f(adapt(f, boost::is_void<typename boost::result_of<F ()>::type>())) {}
+
+        template<class Executor> void pre_fork_parent(Executor& e) const
+        {
+            std::cout.flush();
+            std::cerr.flush();
+            std::fflush(0);
+
+            e.m_child_main     = &call;
+            e.m_child_main_arg = this;
+        }
+
+        callable_type m_f;
+
+    private:
+        template<class F> struct returning_zero
+        {
+            F m_f;
+            explicit returning_zero(F f) : m_f(f) {}
+            int operator()() { m_f(); return 0; }
+        };
+
+        template<class F> static callable_type adapt(F f, boost::true_type)  { return returning_zero<F>(f); }
+        template<class F> static callable_type adapt(F f, boost::false_type) { return f; }
+
+        /// Called in the child in place of exec.
+        static int call(const void* self)
+        {
+            int code = 1;
+            try
+            {
+                code = static_cast<const function*>(self)->m_f();
+            }
+            catch(const std::exception& ex)
+            {
+                report(ex.what());
+            }
+            catch(...)
+            {
+                report("unknown exception");
+            }
+
+            std::cout.flush();
+            std::cerr.flush();
+            std::fflush(0);
+
+            return code;
+        }
+
+        static void report(const char* what)
+        {
+            ssize_t n = ::write(STDERR_FILENO, what, std::strlen(what));
+            n = ::write(STDERR_FILENO, "\n", 1);
+            (void)n;
+        }
+    };
+
+}}}
+
+#endif
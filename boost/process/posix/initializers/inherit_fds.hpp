@@ -0,0 +1,130 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_INITIALIZER_INHERIT_FDS_HPP
+#define BOOST_PROCESS_POSIX_INITIALIZER_INHERIT_FDS_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/initializers/initializer.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#if !defined(BOOST_NO_CXX11_HDR_INITIALIZER_LIST)
+#   include <initializer_list>
+#endif
+
+#include <unistd.h>
+
+namespace boost { namespace process { namespace posix {
+
+    /// Passes fds besides std in/out/err to the child, each under the number the child
+    /// expects. All other fds from 3 up are closed in the child, an fd set in use by another
+    /// initializer under one of the child numbers is replaced.
+    ///
+    /// \code
+    ///     bp::make_child(bp::paths(exe), bp::posix::inherit_fds(listen_socket, 3)(event_fd, 4));
+    /// \endcode
+    struct inherit_fds : public initializer
+    {
+        // multiple inherit_fds initializers can be combined in one sequence, as long as
+        // no child fd is used twice.
+        typedef initializer_combination::ignore combination_category;
+        typedef child_memory::shared child_memory_category;
+
+        typedef std::pair<int, int>       mapping_type; // parent fd, child fd
+        typedef std::vector<mapping_type> mappings_type;
+
+        inherit_fds() : m_mappings() {}
+        inherit_fds(int parent_fd, int child_fd) : m_mappings(1, mapping_type(parent_fd, child_fd)) {}
+        explicit inherit_fds(const mappings_type& m) : m_mappings(m) {}
+
+#if !defined(BOOST_NO_CXX11_HDR_INITIALIZER_LIST)
+        inherit_fds(std::initializer_list<mapping_type> l) : m_mappings(l) {}
+#endif
+
+        inherit_fds& operator()(int parent_fd, int child_fd)
+        {
+            m_mappings.push_back(mapping_type(parent_fd, child_fd));
+
+            return *this;
+        }
+
+        template<class Executor> void pre_fork_parent(Executor& e) const
+        {
+            for(mappings_type::const_iterator it = m_mappings.begin(); it != m_mappings.end(); ++it) e.inherit_fd(it->first, it->second);
+        }
+
+        mappings_type m_mappings;
+    };
+
+    /// Socket activation the way systemd does it: the fds are inherited as 3, 4, ... and the
+    /// child finds their number in LISTEN_FDS, its own pid in LISTEN_PID and, if given, their
+    /// names in LISTEN_FDNAMES. The variables are added to the environment the other
+    /// initializers build.
+    struct listen_fds : public inherit_fds
+    {
+        // only one set of listening fds starts at 3
+        typedef initializer_combination::exclusive combination_category;
+        typedef child_memory::shared child_memory_category;
+
+        enum { first_fd = 3 }; // SD_LISTEN_FDS_START
+
+        explicit listen_fds(int fd) : inherit_fds(fd, first_fd) { init(std::vector<std::string>()); }
+
+        explicit listen_fds(const std::vector<int>& fds, const std::vector<std::string>& names = std::vector<std::string>())
+        {
+            for(std::size_t i = 0; i < fds.size(); ++i) m_mappings.push_back(mapping_type(fds[i], int(first_fd + i)));
+            init(names);
+        }
+
+        template<class Executor> void pre_fork_parent(Executor& e) const
+        {
+            inherit_fds::pre_fork_parent(e);
+
+            e.add_child_env(&m_fds_var[0]);
+            e.add_child_env(m_pid_var);
+            if(!m_names_var.empty()) e.add_child_env(&m_names_var[0]);
+        }
+
+        /// Only the child knows its pid, it is written into the reserved entry without allocating.
+        template<class Executor> void post_fork_child(Executor&) const
+        {
+            char digits[24]; int n = 0;
+            for(long pid = long(getpid()); pid; pid /= 10) digits[n++] = char('0' + pid % 10);
+
+            char* p = m_pid_var + sizeof("LISTEN_PID=") - 1;
+            while(n) *p++ = digits[--n];
+            *p = 0;
+        }
+
+        mutable std::vector<char> m_fds_var;
+        mutable std::vector<char> m_names_var;
+        mutable char              m_pid_var[40];
+
+    private:
+        static void assign(std::vector<char>& var, const std::string& s)
+        {
+            var.assign(s.begin(), s.end()); var.push_back(0);
+        }
+
+        void init(const std::vector<std::string>& names)
+        {
+            assign(m_fds_var, "LISTEN_FDS=" + boost::lexical_cast<std::string>(m_mappings.size()));
+
+            std::string joined;
+            for(std::size_t i = 0; i < names.size(); ++i) joined += (i? ":" : "") + names[i];
+            if(!names.empty()) assign(m_names_var, "LISTEN_FDNAMES=" + joined);
+
+            const char prefix[] = "LISTEN_PID=";
+            for(std::size_t i = 0; i < sizeof(prefix); ++i) m_pid_var[i] = prefix[i];
+        }
+    };
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_INITIALIZER_INHERIT_FDS_HPP
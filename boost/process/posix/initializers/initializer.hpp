@@ -16,8 +16,24 @@ namespace boost { namespace process { namespace posix {
 
 struct executor;
 
+/// What an initializer's post_fork_child hook needs of the child's memory, see launch_backend.
+namespace child_memory
+{
+    /// The hook may rely on a copy of the parent's memory: it allocates, takes locks, throws,
+    /// or writes data the parent reads afterwards. The child is forked.
+    struct copied {};
+
+    /// The hook only makes system calls with data the parent prepared, and what it writes
+    /// is not read by the parent. It can run in a child sharing the parent's memory, which
+    /// is launched without copying page tables.
+    struct shared {};
+}
+
 struct initializer 
 {
+    // user initializers are forked unless they opt in
+    typedef child_memory::copied child_memory_category;
+
     /// This tells us not to check for conflicts with other initializers in an
     /// InitializerSequence.
     template<class Executor> void    pre_fork_parent(Executor&) const {}
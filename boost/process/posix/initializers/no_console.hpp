@@ -14,7 +14,10 @@
 
 namespace boost { namespace process { namespace posix {
 
-    struct no_console : public initializer {};
+    struct no_console : public initializer
+    {
+        typedef child_memory::shared child_memory_category;
+    };
 
 }}}
 
@@ -13,34 +13,88 @@
 #include <boost/process/posix/initializers/initializer.hpp>
 
 #include <boost/filesystem/path.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
 
+#include <cerrno>
 #include <vector>
 #include <string>
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace boost { namespace process { namespace posix {
 
+    /// The executable to launch and the directory to run it in, by default the one holding
+    /// the executable. A relative executable is found from the working directory.
+    ///
+    /// Where the system has O_PATH (Linux 2.6.39) the constructor opens both once, and every
+    /// launch with the same paths object, from any thread, reuses them: the child changes
+    /// directory with fchdir and execs the opened file with execveat (Linux 3.19), so neither
+    /// path is walked again, and renaming or replacing the file meanwhile does not change what
+    /// runs. Construct a new paths object to pick up a replaced executable. If either cannot be opened, or the
+    /// executable is no regular file, the child uses the paths as given and reports the
+    /// failure as usual.
     struct paths : public initializer 
     {
         // multiple paths initializers cannot be combined in one sequence.
         typedef initializer_combination::exclusive combination_category;
+        typedef child_memory::shared child_memory_category;
 
         typedef boost::filesystem::path path;
         typedef std::vector<char>       path_chars;
+
+        /// O_PATH fds, shared by the copies of a paths object; -1 where not opened.
+        struct handles : private boost::noncopyable
+        {
+            int m_exe_fd;
+            int m_dir_fd;
+
+            handles(const path& exe, const path& working_dir) : m_exe_fd(-1), m_dir_fd(-1)
+            {
+#if defined(O_PATH)
+                if(!working_dir.empty())
+                {
+                    if((m_dir_fd = ::open(working_dir.c_str(), O_PATH|O_DIRECTORY|O_CLOEXEC)) == -1) return;
+                }
+
+                m_exe_fd = ::openat((m_dir_fd != -1)? m_dir_fd : AT_FDCWD, exe.c_str(), O_PATH|O_CLOEXEC);
+
+                struct stat st;
+                if(m_exe_fd != -1 && (::fstat(m_exe_fd, &st) == -1 || !S_ISREG(st.st_mode)))
+                {
+                    ::close(m_exe_fd); m_exe_fd = -1;
+                }
+#else
+                (void)exe; (void)working_dir;
+#endif
+            }
+
+            ~handles()
+            {
+                if(m_exe_fd != -1) ::close(m_exe_fd);
+                if(m_dir_fd != -1) ::close(m_dir_fd);
+            }
+        };
         
-                path       m_exe;
-                path       m_working_dir;
-        mutable path_chars m_chars;
+                path                         m_exe;
+                path                         m_working_dir;
+        mutable path_chars                   m_chars;
+                boost::shared_ptr<handles>   m_handles;
         
         paths(const path& exe) 
         : m_exe        (exe)
         , m_working_dir(exe.parent_path())
         , m_chars      (path_as_chars(exe.string()))
+        , m_handles    (new handles(m_exe, m_working_dir))
         {}
         
         paths(const path& exe, const path& working_dir) 
         : m_exe        (exe)
         , m_working_dir(working_dir)
         , m_chars      (path_as_chars(exe.string()))
+        , m_handles    (new handles(m_exe, m_working_dir))
         {}
 
         static path_chars path_as_chars(const std::string& s)
@@ -53,13 +107,19 @@ namespace boost { namespace process { namespace posix {
         template<class Executor> void  pre_fork_parent(Executor& e) const 
         { 
             e.m_exe = m_exe;
+            if(m_handles->m_exe_fd != -1) e.m_exe_fd = m_handles->m_exe_fd;
             e.m_arg_ptrs.assign_app(&m_chars[0]); 
         } 
         template<class Executor> void post_fork_child (Executor& e) const 
         {
-            if(chdir(m_working_dir.c_str()) == -1)
+            if(m_handles->m_dir_fd != -1)
+            {
+                if(fchdir(m_handles->m_dir_fd) == -1) e.child_throw(errno, "fchdir", m_working_dir.c_str());
+            }
+            // an exe without a parent path runs in the current directory
+            else if(!m_working_dir.empty() && chdir(m_working_dir.c_str()) == -1)
             {
-                e.child_throw(errno);
+                e.child_throw(errno, "chdir", m_working_dir.c_str());
             }
         }
     };
@@ -0,0 +1,98 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_INITIALIZER_PROCESS_GROUP_HPP
+#define BOOST_PROCESS_POSIX_INITIALIZER_PROCESS_GROUP_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/child.hpp>
+#include <boost/process/posix/initializers/initializer.hpp>
+
+#include <cerrno>
+
+#include <unistd.h>
+
+namespace boost { namespace process { namespace posix {
+
+    /// Makes the child the leader of a new process group with its pid as the group id, so
+    /// it and everything it starts can be signalled at once, e.g. by a termination_policy.
+    struct new_process_group : public initializer
+    {
+        // a child is in exactly one process group
+        typedef initializer_combination::exclusive combination_category;
+        typedef child_memory::shared child_memory_category;
+
+        template<class Executor> void post_fork_child(Executor& e) const
+        {
+            if(setpgid(0, 0) == -1) e.child_throw(errno, "setpgid");
+        }
+
+        /// The parent sets it as well, so the group exists as soon as make_child returns.
+        template<class Executor> void post_fork_parent(Executor& e) const
+        {
+            setpgid(e.m_pid, e.m_pid); // fails harmlessly once the child exec'd
+        }
+    };
+
+    /// Puts the child into an existing process group of the same session, typically one
+    /// whose leader was launched with new_process_group, so all are signalled and reaped
+    /// together.
+    ///
+    /// \code
+    ///     bp::child leader = bp::make_child(bp::paths(server), bp::posix::new_process_group());
+    ///     bp::make_child(bp::paths(worker), bp::posix::join_process_group(leader));
+    ///     bp::posix::process_group_monitor(leader).terminate(bp::posix::termination_policy(), statuses);
+    /// \endcode
+    struct join_process_group : public initializer
+    {
+        typedef initializer_combination::exclusive combination_category;
+        typedef child_memory::shared child_memory_category;
+
+        explicit join_process_group(pid_t pgid) : m_pgid(pgid) {}
+        explicit join_process_group(const child& leader) : m_pgid(leader.handle()) {}
+
+        template<class Executor> void post_fork_child(Executor& e) const
+        {
+            if(setpgid(0, m_pgid) == -1) e.child_throw(errno, "setpgid");
+        }
+
+        template<class Executor> void post_fork_parent(Executor& e) const
+        {
+            setpgid(e.m_pid, m_pgid);
+        }
+
+        pid_t m_pgid;
+    };
+
+    /// Makes the child the leader of a new session, and of a new process group in it, without
+    /// a controlling terminal. Signals from the terminal the parent runs in do not reach it.
+    /// Only one of new_process_group, join_process_group and new_session can take effect.
+    ///
+    /// Only the child can call setsid, so make_child waits until it exec'd, as with
+    /// throw_on_launch_error.
+    struct new_session : public initializer
+    {
+        typedef initializer_combination::exclusive combination_category;
+        typedef child_memory::shared child_memory_category;
+
+        template<class Executor> void pre_fork_parent(Executor& e) const
+        {
+            e.use_error_pipe();
+        }
+
+        template<class Executor> void post_fork_parent(Executor& e) const
+        {
+            e.wait_for_exec();
+        }
+
+        template<class Executor> void post_fork_child(Executor& e) const
+        {
+            if(setsid() == -1) e.child_throw(errno, "setsid");
+        }
+    };
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_INITIALIZER_PROCESS_GROUP_HPP
@@ -13,6 +13,8 @@
 #include <boost/optional.hpp>
 #include <boost/process/file_descriptor_ray.hpp>
 
+#include <fcntl.h>
+
 namespace boost { namespace process { namespace posix {
 
     struct executor;
@@ -23,6 +25,22 @@ namespace boost { namespace process { namespace posix {
         typedef boost::iostreams::file_descriptor_source source_type;
         typedef boost::iostreams::file_descriptor_sink     sink_type;
 
+        /// Opens p in the child. Failures are reported through the executor, since
+        /// an exception must not unwind into the parent's stack from the child.
+        template<class Executor> static int child_open(Executor& e, const path& p, int flags)
+        {
+            int fd = -1;
+
+            do
+            {
+                fd = ::open(p.c_str(), flags, 0666);
+            }
+            while(fd == -1 && errno == EINTR);
+
+            if(fd == -1) e.child_throw(errno, "open", p.c_str());
+
+            return fd;
+        }
     };
     
     //////////////////////////////////////////////////////////////////////////
@@ -31,54 +49,48 @@ namespace boost { namespace process { namespace posix {
     {
         // multiple std_in initializers cannot be combined in one sequence. TODO put both std_in_from_path and std_in_from into a single structure with the same combination_category
         typedef initializer_combination::exclusive combination_category;
+        typedef child_memory::shared child_memory_category;
 
-        std_in_from_path(const path& p) : io_initializer(), m_path(p), m_source() {}
+        std_in_from_path(const path& p) : io_initializer(), m_path(p) {}
         
         template<class Executor> void post_fork_child(Executor& e) const
         {
-            m_source = source_type(m_path.string());
-            
-            e.set_std_in((*m_source).handle());
+            e.set_std_in(child_open(e, m_path, O_RDONLY));
         }
         
-        path                                 m_path;
-        mutable boost::optional<source_type> m_source;
+        path m_path;
     };
     
     struct std_out_to_path : io_initializer
     {
         // multiple std_out initializers cannot be combined in one sequence. TODO put both std_out_to_path and std_out_to into a single structure with the same combination_category
         typedef initializer_combination::exclusive combination_category;
+        typedef child_memory::shared child_memory_category;
 
-        std_out_to_path(const path& p) : io_initializer(), m_path(p), m_sink() {}
+        std_out_to_path(const path& p) : io_initializer(), m_path(p) {}
         
         template<class Executor> void post_fork_child(Executor& e) const
         {
-            m_sink = sink_type(m_path.string());
-            
-            e.set_std_out((*m_sink).handle());
+            e.set_std_out(child_open(e, m_path, O_WRONLY|O_CREAT|O_TRUNC));
         }
         
-        path                               m_path;
-        mutable boost::optional<sink_type> m_sink;
+        path m_path;
     };
     
     struct std_err_to_path : io_initializer
     {
         // multiple std_err initializers cannot be combined in one sequence. TODO put both std_err_to_path and std_err_to into a single structure with the same combination_category
         typedef initializer_combination::exclusive combination_category;
+        typedef child_memory::shared child_memory_category;
 
-        std_err_to_path(const path& p) : io_initializer(), m_path(p), m_sink() {}
+        std_err_to_path(const path& p) : io_initializer(), m_path(p) {}
         
         template<class Executor> void post_fork_child(Executor& e) const
         {
-            m_sink = sink_type(m_path.string());
-            
-            e.set_std_err((*m_sink).handle());
+            e.set_std_err(child_open(e, m_path, O_WRONLY|O_CREAT|O_TRUNC));
         }
         
-        path                               m_path;
-        mutable boost::optional<sink_type> m_sink;
+        path m_path;
     };
     
     //////////////////////////////////////////////////////////////////////////
@@ -87,6 +99,7 @@ namespace boost { namespace process { namespace posix {
     {
         // multiple std_in initializers cannot be combined in one sequence. TODO put both std_in_from_path and std_in_from into a single structure with the same combination_category
         typedef initializer_combination::exclusive combination_category;
+        typedef child_memory::shared child_memory_category;
 
         std_in_from(const         source_type& s) : io_initializer(), m_source(s         ) {}
         std_in_from(const file_descriptor_ray& r) : io_initializer(), m_source(r.m_source) {}
@@ -103,6 +116,7 @@ namespace boost { namespace process { namespace posix {
     {
         // multiple std_out initializers cannot be combined in one sequence. TODO put both std_out_to_path and std_out_to into a single structure with the same combination_category
         typedef initializer_combination::exclusive combination_category;
+        typedef child_memory::shared child_memory_category;
 
         std_out_to(const           sink_type& s) : io_initializer(), m_sink(s       ) {}
         std_out_to(const file_descriptor_ray& r) : io_initializer(), m_sink(r.m_sink) {}
@@ -119,6 +133,7 @@ namespace boost { namespace process { namespace posix {
     {
         // multiple std_in initializers cannot be combined in one sequence. TODO put both std_in_from_path and std_in_from into a single structure with the same combination_category
         typedef initializer_combination::exclusive combination_category;
+        typedef child_memory::shared child_memory_category;
 
         std_err_to(const           sink_type& s) : io_initializer(), m_sink(s       ) {}
         std_err_to(const file_descriptor_ray& r) : io_initializer(), m_sink(r.m_sink) {}
@@ -0,0 +1,220 @@
+
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_INITIALIZER_STD_IO_MEMORY_HPP
+#define BOOST_PROCESS_POSIX_INITIALIZER_STD_IO_MEMORY_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/detail/helpers.hpp>
+#include <boost/process/posix/initializers/initializer.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <cerrno>
+#include <string>
+#include <vector>
+
+#if !defined(__linux__)
+#   error "the memory std_io initializers require Linux (memfd_create)"
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace boost { namespace process { namespace posix {
+
+    /// Anonymous file in memory (a memfd) the parent fills or reads and a child uses as a std stream.
+    class memory_file : private boost::noncopyable
+    {
+    public:
+        /// An executable one asks for MFD_EXEC (Linux 6.3), which kernels set up to refuse
+        /// running memfds need; older kernels reject the flag and run any memfd.
+        explicit memory_file(const char* name, bool executable = false)
+        : m_fd(-1), m_map(0), m_map_size(0)
+        {
+            const unsigned int mfd_exec = 0x0010U; // MFD_EXEC, missing from older headers
+
+            if(executable) m_fd = ::memfd_create(name, MFD_CLOEXEC|MFD_ALLOW_SEALING|mfd_exec);
+            if(m_fd == -1) m_fd = ::memfd_create(name, MFD_CLOEXEC|MFD_ALLOW_SEALING);
+            if(m_fd == -1) detail::throw_last_error();
+        }
+
+        ~memory_file()
+        {
+            unmap();
+            close(m_fd);
+        }
+
+        int handle() const { return m_fd; }
+
+        void write_all(const char* data, std::size_t len)
+        {
+            while(len)
+            {
+                ssize_t n = ::write(m_fd, data, len);
+                if(n == -1)
+                {
+                    if(errno == EINTR) continue;
+                    detail::throw_last_error();
+                }
+                data += n; len -= std::size_t(n);
+            }
+        }
+
+        /// After this nobody, including the children, can modify the content any more.
+        void seal()
+        {
+            if(fcntl(m_fd, F_ADD_SEALS, F_SEAL_WRITE|F_SEAL_SHRINK|F_SEAL_GROW|F_SEAL_SEAL) == -1) detail::throw_last_error();
+        }
+
+        void clear()
+        {
+            unmap();
+            if(ftruncate(m_fd, 0) == -1 || lseek(m_fd, 0, SEEK_SET) == -1) detail::throw_last_error();
+        }
+
+        std::size_t size() const
+        {
+            struct stat st;
+            if(fstat(m_fd, &st) == -1) detail::throw_last_error();
+
+            return std::size_t(st.st_size);
+        }
+
+        /// Maps the current content read-only, the mapping is valid until clear() or destruction.
+        const char* data() const
+        {
+            const std::size_t n = size();
+            if(n != m_map_size)
+            {
+                unmap();
+                if(n)
+                {
+                    void* p = mmap(0, n, PROT_READ, MAP_SHARED, m_fd, 0);
+                    if(p == MAP_FAILED) detail::throw_last_error();
+
+                    m_map = static_cast<char*>(p); m_map_size = n;
+                }
+            }
+            return m_map;
+        }
+
+        /// Called in the child: a file description of its own, so the read offset is not
+        /// shared with the parent or other children using the same memory_file.
+        template<class Executor> int reopen_in_child(Executor& e, int flags) const
+        {
+            char proc_path[32] = "/proc/self/fd/";
+            append_int(proc_path + 14, m_fd);
+
+            int fd = ::open(proc_path, flags);
+            if(fd == -1)
+            {
+                // no /proc, share the description and rewind it
+                fd = m_fd;
+                if(lseek(fd, 0, SEEK_SET) == -1) e.child_throw(errno, "lseek", "memory_file");
+            }
+            return fd;
+        }
+
+    private:
+        /// async-signal-safe formatting of a non negative int
+        static void append_int(char* p, int v)
+        {
+            char digits[12]; int n = 0;
+            do { digits[n++] = char('0' + v % 10); v /= 10; } while(v);
+            while(n) *p++ = digits[--n];
+            *p = 0;
+        }
+
+        void unmap() const
+        {
+            if(m_map) munmap(m_map, m_map_size);
+            m_map = 0; m_map_size = 0;
+        }
+
+        int                 m_fd;
+        mutable char*       m_map;
+        mutable std::size_t m_map_size;
+    };
+
+    /// Feeds the child's stdin from a sealed in-memory copy of the buffer, without a pipe
+    /// that must be pumped and without touching the file system. The copy is made once,
+    /// every child launched with the initializer reads it from the start.
+    struct std_in_from_memory : public initializer
+    {
+        // multiple std_in initializers cannot be combined in one sequence.
+        typedef initializer_combination::exclusive combination_category;
+        typedef child_memory::shared child_memory_category;
+
+        std_in_from_memory(const std::string&       s) : m_file(new memory_file("boost_process_std_in")) { fill(s.data(), s.size()); }
+        std_in_from_memory(const std::vector<char>& v) : m_file(new memory_file("boost_process_std_in")) { fill(v.empty()? 0 : &v[0], v.size()); }
+        std_in_from_memory(const char* data, std::size_t len) : m_file(new memory_file("boost_process_std_in")) { fill(data, len); }
+
+        template<class Executor> void post_fork_child(Executor& e) const
+        {
+            e.set_std_in(m_file->reopen_in_child(e, O_RDONLY));
+        }
+
+        boost::shared_ptr<memory_file> m_file;
+
+    private:
+        void fill(const char* data, std::size_t len)
+        {
+            m_file->write_all(data, len);
+            m_file->seal();
+        }
+    };
+
+    /// Captures a child's stream in memory. After the child was joined the parent reads the
+    /// output through a mapping with data() and size(), or copies it with str().
+    struct memory_sink_initializer : public initializer
+    {
+        explicit memory_sink_initializer(const char* name) : m_file(new memory_file(name)) {}
+
+        const char* data() const { return m_file->data(); }
+        std::size_t size() const { return m_file->size(); }
+        std::string str () const { const char* p = data(); return std::string(p, p + size()); }
+
+        /// Discards the captured output, so the initializer can be used for another launch.
+        void clear() { m_file->clear(); }
+
+        boost::shared_ptr<memory_file> m_file;
+    };
+
+    struct std_out_to_memory : public memory_sink_initializer
+    {
+        // multiple std_out initializers cannot be combined in one sequence.
+        typedef initializer_combination::exclusive combination_category;
+        typedef child_memory::shared child_memory_category;
+
+        std_out_to_memory() : memory_sink_initializer("boost_process_std_out") {}
+
+        template<class Executor> void post_fork_child(Executor& e) const
+        {
+            e.set_std_out(m_file->handle());
+        }
+    };
+
+    struct std_err_to_memory : public memory_sink_initializer
+    {
+        // multiple std_err initializers cannot be combined in one sequence.
+        typedef initializer_combination::exclusive combination_category;
+        typedef child_memory::shared child_memory_category;
+
+        std_err_to_memory() : memory_sink_initializer("boost_process_std_err") {}
+
+        template<class Executor> void post_fork_child(Executor& e) const
+        {
+            e.set_std_err(m_file->handle());
+        }
+    };
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_INITIALIZER_STD_IO_MEMORY_HPP
@@ -11,6 +11,7 @@
 
 #include <boost/process/config.hpp>
 #include <boost/process/posix/initializers/initializer.hpp>
+#include <boost/process/posix/launch_error.hpp>
 #include <boost/system/system_error.hpp>
 
 #include <fcntl.h>
@@ -19,8 +20,14 @@ namespace boost { namespace process { namespace posix {
 
     struct executor;
 
-    template<typename X = boost::system::system_error> struct throw_on_launch_error : public initializer 
+    /// Reports failures of the child before exec back to the parent as exceptions of type X.
+    /// The default launch_error tells the launch stage, the initializer and the errno.
+    template<typename X = launch_error> struct throw_on_launch_error : public initializer 
     {
+        // multiple throw_on_launch_error initializers cannot be combined in one sequence.
+        typedef initializer_combination::exclusive combination_category;
+        typedef child_memory::shared child_memory_category;
+
         typedef X exception_type;
         
         throw_on_launch_error() {}
@@ -33,10 +40,14 @@ namespace boost { namespace process { namespace posix {
         {
             e.template parent_throw_if<exception_type>();
         }
-        template<class Executor> void failed_exec_child(Executor& e) const
+        template<class Executor> void failed_fork_parent(Executor& e) const
         {
-            e.child_throw(errno);
+            launch_report r;
+            r.assign(launch_report::fork, -1, errno, "fork", 0);
+
+            e.template parent_throw<exception_type>(r);
         }
+        // a failed exec is reported by the executor itself, see executor::child_throw
     
     };
 
@@ -0,0 +1,173 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_IO_URING_HPP
+#define BOOST_PROCESS_POSIX_IO_URING_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/detail/helpers.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <cerrno>
+#include <cstring>
+
+#if !defined(__linux__)
+#   error "io_uring_ring requires Linux"
+#endif
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace boost { namespace process { namespace posix {
+
+    /// The submission and completion rings of an io_uring instance, driven through the
+    /// plain system calls, without liburing.
+    ///
+    /// Needs Linux 5.11 or later: a single mapping for both rings, no dropped completions,
+    /// internal polling for pipes and waits with a timeout. The constructor throws a
+    /// system_error where these are missing, ENOSYS or EPERM where io_uring is not
+    /// available at all.
+    class io_uring_ring : private boost::noncopyable
+    {
+    public:
+        explicit io_uring_ring(unsigned entries) : m_fd(-1), m_ring(MAP_FAILED), m_ring_size(0), m_sqes(0), m_sqes_size(0)
+        {
+            io_uring_params p;
+            std::memset(&p, 0, sizeof(p));
+            p.flags      = IORING_SETUP_CQSIZE;
+            p.cq_entries = 4 * entries;
+
+            m_fd = int(::syscall(SYS_io_uring_setup, entries, &p));
+            if(m_fd == -1) detail::throw_last_error();
+
+            const unsigned needed = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_FAST_POLL | IORING_FEAT_EXT_ARG;
+            if((p.features & needed) != needed)
+            {
+                close(m_fd);
+                errno = ENOTSUP;
+                detail::throw_last_error();
+            }
+
+            const std::size_t sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+            const std::size_t cq_size = p.cq_off.cqes  + p.cq_entries * sizeof(io_uring_cqe);
+
+            m_ring_size = (sq_size > cq_size)? sq_size : cq_size;
+            m_ring      = ::mmap(0, m_ring_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+            if(m_ring == MAP_FAILED) { int e = errno; close(m_fd); errno = e; detail::throw_last_error(); }
+
+            m_sqes_size = p.sq_entries * sizeof(io_uring_sqe);
+            void* sqes  = ::mmap(0, m_sqes_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, m_fd, IORING_OFF_SQES);
+            if(sqes == MAP_FAILED) { int e = errno; ::munmap(m_ring, m_ring_size); close(m_fd); errno = e; detail::throw_last_error(); }
+            m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+            char* r = static_cast<char*>(m_ring);
+
+            m_sq_head    = reinterpret_cast<unsigned*>(r + p.sq_off.head);
+            m_sq_tail    = reinterpret_cast<unsigned*>(r + p.sq_off.tail);
+            m_sq_mask    = *reinterpret_cast<unsigned*>(r + p.sq_off.ring_mask);
+            m_sq_entries = p.sq_entries;
+
+            // slot i always submits sqe i
+            unsigned* array = reinterpret_cast<unsigned*>(r + p.sq_off.array);
+            for(unsigned i = 0; i < p.sq_entries; ++i) array[i] = i;
+
+            m_cq_head = reinterpret_cast<unsigned*>(r + p.cq_off.head);
+            m_cq_tail = reinterpret_cast<unsigned*>(r + p.cq_off.tail);
+            m_cq_mask = *reinterpret_cast<unsigned*>(r + p.cq_off.ring_mask);
+            m_cqes    = reinterpret_cast<io_uring_cqe*>(r + p.cq_off.cqes);
+
+            m_local_tail = *m_sq_tail;
+        }
+
+        ~io_uring_ring()
+        {
+            ::munmap(m_sqes, m_sqes_size);
+            ::munmap(m_ring, m_ring_size);
+            close(m_fd);
+        }
+
+        /// A cleared submission entry, submitted with the next submit or wait. Submits the
+        /// queued entries first if the ring is full.
+        io_uring_sqe& get_sqe()
+        {
+            while(m_local_tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) == m_sq_entries) enter(0, -1);
+
+            io_uring_sqe& s = m_sqes[m_local_tail & m_sq_mask];
+            std::memset(&s, 0, sizeof(s));
+            ++m_local_tail;
+
+            return s;
+        }
+
+        /// Submits the queued entries without waiting.
+        void submit() { enter(0, -1); }
+
+        /// Submits the queued entries and waits up to timeout_ms milliseconds, -1 for no
+        /// limit, until there is a completion. Returns false on timeout.
+        bool submit_and_wait(int timeout_ms) { return enter(1, timeout_ms); }
+
+        /// Hands each completion to f, consuming it first so f may submit and throw.
+        template<class F> std::size_t consume(F& f)
+        {
+            std::size_t n = 0;
+            for(unsigned head = *m_cq_head; head != __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE); ++n)
+            {
+                io_uring_cqe c = m_cqes[head & m_cq_mask];
+                __atomic_store_n(m_cq_head, ++head, __ATOMIC_RELEASE);
+
+                f(c);
+            }
+            return n;
+        }
+
+        int fd() const { return m_fd; }
+
+    private:
+        bool enter(unsigned wait_nr, int timeout_ms)
+        {
+            __atomic_store_n(m_sq_tail, m_local_tail, __ATOMIC_RELEASE);
+            const unsigned to_submit = m_local_tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE);
+
+            __kernel_timespec ts = { timeout_ms / 1000, (timeout_ms % 1000) * 1000000LL };
+
+            io_uring_getevents_arg arg;
+            std::memset(&arg, 0, sizeof(arg));
+            if(wait_nr && timeout_ms >= 0) arg.ts = reinterpret_cast<__u64>(&ts);
+
+            const unsigned flags = IORING_ENTER_EXT_ARG | (wait_nr? IORING_ENTER_GETEVENTS : 0);
+
+            if(::syscall(SYS_io_uring_enter, m_fd, to_submit, wait_nr, flags, &arg, sizeof(arg)) == -1)
+            {
+                if(errno == ETIME)                   return false;
+                if(errno == EINTR || errno == EBUSY) return true; // the caller consumes and comes back
+                detail::throw_last_error();
+            }
+            return true;
+        }
+
+        int           m_fd;
+        void*         m_ring;
+        std::size_t   m_ring_size;
+        io_uring_sqe* m_sqes;
+        std::size_t   m_sqes_size;
+
+        unsigned*     m_sq_head;
+        unsigned*     m_sq_tail;
+        unsigned      m_sq_mask;
+        unsigned      m_sq_entries;
+        unsigned      m_local_tail; // entries queued, published to the kernel on enter
+
+        unsigned*     m_cq_head;
+        unsigned*     m_cq_tail;
+        unsigned      m_cq_mask;
+        io_uring_cqe* m_cqes;
+    };
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_IO_URING_HPP
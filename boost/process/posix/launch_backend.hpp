@@ -0,0 +1,207 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_LAUNCH_BACKEND_HPP
+#define BOOST_PROCESS_POSIX_LAUNCH_BACKEND_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/detail/helpers.hpp>
+#include <boost/atomic.hpp>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace boost { namespace process { namespace posix {
+
+    /// Process wide choice of how the executor creates children, with counters of the choices.
+    ///
+    /// fork copies the parent's page tables, which takes longer the more memory is resident,
+    /// stalls page faults of the parent's other threads meanwhile, and fails with ENOMEM under
+    /// strict overcommit (vm.overcommit_memory = 2) when the copy cannot be committed. The
+    /// vfork backend, clone with CLONE_VM|CLONE_VFORK as glibc's posix_spawn uses it, shares
+    /// the parent's memory instead: nothing is copied, and only the launching thread waits
+    /// until the child exec'd. It is Linux only, and only taken if every initializer of the
+    /// launch declares child_memory::shared, which the library's do, except function.
+    ///
+    /// automatic, the default, takes the vfork backend for such launches if the parent has
+    /// vfork_threshold() bytes resident or more, more than one thread, or strict overcommit.
+    /// Small single threaded parents fork: it costs them only some 100 us more, and a child
+    /// that misbehaves in a hook cannot corrupt the parent's memory. The factors come
+    /// from /proc/self/statm and /proc/self/stat, sampled at most every sample_interval_ms.
+    /// A fork failing with ENOMEM is retried with the vfork backend where the launch allows it.
+    ///
+    /// \code
+    ///     bp::make_child(bp::paths(exe), bp::std_out_to(ray)); // vfork backend in a large server
+    ///     std::size_t n = bp::posix::launch_backend::launches(bp::posix::launch_backend::vfork_backend);
+    /// \endcode
+    class launch_backend
+    {
+    public:
+        enum backend_type
+        {
+            fork_backend  = 0,
+            vfork_backend = 1
+        };
+
+        enum policy_type
+        {
+            automatic,       ///< by the factors above
+            always_fork,     ///< fork only, no ENOMEM fallback either
+            vfork_when_safe  ///< the vfork backend for every launch that allows it
+        };
+
+        enum { sample_interval_ms = 100 };
+
+        static void        set_policy(policy_type p) { instance().m_policy.store(p, boost::memory_order_relaxed); }
+        static policy_type policy()                  { return policy_type(instance().m_policy.load(boost::memory_order_relaxed)); }
+
+        /// Resident bytes from which automatic takes the vfork backend, 32 MB by default.
+        static void        set_vfork_threshold(std::size_t bytes) { instance().m_vfork_threshold.store(bytes, boost::memory_order_relaxed); }
+        static std::size_t vfork_threshold()                      { return instance().m_vfork_threshold.load(boost::memory_order_relaxed); }
+
+        /// The backend for a launch whose initializers all share the child's memory, or not.
+        static backend_type choose(bool shared_memory)
+        {
+            if(!available() || !shared_memory) return fork_backend;
+
+            registry& g = instance();
+            switch(g.m_policy.load(boost::memory_order_relaxed))
+            {
+                case always_fork:     return fork_backend;
+                case vfork_when_safe: return vfork_backend;
+                default:              break;
+            }
+
+            if(strict_overcommit()) return vfork_backend;
+
+            sample(g);
+            if(g.m_threads.load(boost::memory_order_relaxed) > 1) return vfork_backend;
+
+            return (g.m_resident.load(boost::memory_order_relaxed) >= g.m_vfork_threshold.load(boost::memory_order_relaxed))? vfork_backend : fork_backend;
+        }
+
+        /// Whether a fork that failed with ENOMEM may be retried with the vfork backend.
+        static bool fallback_on_enomem(bool shared_memory)
+        {
+            return available() && shared_memory && policy() != always_fork;
+        }
+
+        /// Whether this platform has the vfork backend.
+        static bool available()
+        {
+#if defined(__linux__)
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        /// Children created with backend b, counting fallbacks under their final backend.
+        static std::size_t launches(backend_type b) { return instance().m_launches[b].load(boost::memory_order_relaxed); }
+
+        /// Forks that failed with ENOMEM and were retried with the vfork backend.
+        static std::size_t enomem_fallbacks() { return instance().m_enomem_fallbacks.load(boost::memory_order_relaxed); }
+
+        static void reset_counters()
+        {
+            registry& g = instance();
+            g.m_launches[fork_backend ].store(0, boost::memory_order_relaxed);
+            g.m_launches[vfork_backend].store(0, boost::memory_order_relaxed);
+            g.m_enomem_fallbacks.store(0, boost::memory_order_relaxed);
+        }
+
+        /// Called by the executor.
+        static void count_launch(backend_type b) { instance().m_launches[b].fetch_add(1, boost::memory_order_relaxed); }
+        static void count_enomem_fallback()      { instance().m_enomem_fallbacks.fetch_add(1, boost::memory_order_relaxed); }
+
+        /// The parent's resident memory in bytes, 0 where /proc is missing.
+        static std::size_t resident_bytes()
+        {
+            char buffer[128];
+            if(!read_file("/proc/self/statm", buffer, sizeof(buffer))) return 0;
+
+            const char* resident = std::strchr(buffer, ' '); // after the total size
+            return resident? std::size_t(std::strtoul(resident, 0, 10)) * std::size_t(sysconf(_SC_PAGESIZE)) : 0;
+        }
+
+        /// The parent's number of threads, 1 where /proc is missing.
+        static std::size_t threads()
+        {
+            char buffer[1024];
+            if(!read_file("/proc/self/stat", buffer, sizeof(buffer))) return 1;
+
+            // the fields after the command name, which may contain spaces; num_threads is the 18th
+            const char* p = std::strrchr(buffer, ')');
+            for(int field = 0; p && field < 18; ++field) p = std::strchr(p + 1, ' ');
+
+            return p? std::size_t(std::strtoul(p + 1, 0, 10)) : 1;
+        }
+
+        /// vm.overcommit_memory is 2, read once.
+        static bool strict_overcommit() { return instance().m_strict_overcommit; }
+
+    private:
+        struct registry
+        {
+            boost::atomic<int>         m_policy;
+            boost::atomic<std::size_t> m_vfork_threshold;
+            boost::atomic<std::size_t> m_launches[2];
+            boost::atomic<std::size_t> m_enomem_fallbacks;
+            boost::atomic<long long>   m_sampled_ms;  // -1 before the first sample
+            boost::atomic<std::size_t> m_resident;
+            boost::atomic<std::size_t> m_threads;
+            bool                       m_strict_overcommit;
+
+            registry() : m_policy(automatic), m_vfork_threshold(32 << 20), m_enomem_fallbacks(0), m_sampled_ms(-1), m_resident(0), m_threads(1), m_strict_overcommit(false)
+            {
+                m_launches[fork_backend ].store(0);
+                m_launches[vfork_backend].store(0);
+
+                char buffer[16];
+                m_strict_overcommit = read_file("/proc/sys/vm/overcommit_memory", buffer, sizeof(buffer)) && buffer[0] == '2';
+            }
+        };
+
+        static registry& instance() { return detail::leaked_singleton<registry>::instance(); }
+
+        /// Refreshes the factors if the last sample is older than sample_interval_ms. Racing
+        /// threads may both sample, either result will do.
+        static void sample(registry& g)
+        {
+            const long long now = detail::coarse_now_ms();
+            const long long at  = g.m_sampled_ms.load(boost::memory_order_relaxed);
+            if(at != -1 && now - at < sample_interval_ms) return;
+
+            g.m_sampled_ms.store(now, boost::memory_order_relaxed);
+            g.m_resident.store(resident_bytes(), boost::memory_order_relaxed);
+            g.m_threads .store(threads(),        boost::memory_order_relaxed);
+        }
+
+        /// Reads a small file into a null terminated buffer.
+        static bool read_file(const char* path, char* buffer, std::size_t size)
+        {
+            int fd = ::open(path, O_RDONLY|O_CLOEXEC);
+            if(fd == -1) return false;
+
+            ssize_t n;
+            while((n = ::read(fd, buffer, size - 1)) == -1 && errno == EINTR) {}
+            close(fd);
+
+            if(n <= 0) return false;
+            buffer[n] = 0;
+            return true;
+        }
+    };
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_LAUNCH_BACKEND_HPP
@@ -0,0 +1,133 @@
+
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_LAUNCH_ERROR_HPP
+#define BOOST_PROCESS_POSIX_LAUNCH_ERROR_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <string>
+
+#include <limits.h>
+
+namespace boost { namespace process { namespace posix {
+
+    /// Fixed-size record describing why a forked child could not exec.
+    ///
+    /// The child fills it in without allocating and sends it to the parent with a single
+    /// write(), which is atomic because the record is smaller than PIPE_BUF.
+    struct launch_report
+    {
+        enum stage_type
+        {
+            no_stage        = 0,
+            post_fork_child = 1, // an initializer's post_fork_child hook, see m_initializer
+            set_std_fds     = 2,
+            close_fds       = 3,
+            exec            = 4,
+            fork            = 5, // reported by the parent itself, no child was created
+            inherit_fds     = 6  // moving inherited fds to their child numbers
+        };
+
+        enum { context_size = 52 };
+
+        int  m_stage;
+        int  m_initializer; // index in the InitializerSequence, -1 outside the initializers
+        int  m_errno;
+        char m_context[context_size];
+
+        void assign(int stage, int initializer, int err, const char* what, const char* detail)
+        {
+            m_stage       = stage;
+            m_initializer = initializer;
+            m_errno       = err;
+
+            // async-signal-safe concatenation of "what: detail", silently truncated
+            std::size_t n = 0;
+
+            for(; what   && *what   && n < context_size - 1; ++what  ) m_context[n++] = *what;
+            if(what && detail)
+            {
+                for(const char* sep = ": "; *sep && n < context_size - 1; ++sep) m_context[n++] = *sep;
+            }
+            for(; detail && *detail && n < context_size - 1; ++detail) m_context[n++] = *detail;
+
+            m_context[n] = 0;
+        }
+
+        boost::system::error_code code() const
+        {
+            return boost::system::error_code(m_errno, boost::system::system_category());
+        }
+
+        static const char* stage_name(int stage)
+        {
+            switch(stage)
+            {
+                case post_fork_child: return "post_fork_child";
+                case set_std_fds    : return "set_std_fds";
+                case close_fds      : return "close_fds";
+                case exec           : return "exec";
+                case fork           : return "fork";
+                case inherit_fds    : return "inherit_fds";
+                default             : return "unknown stage";
+            }
+        }
+
+        std::string describe() const
+        {
+            std::string s = stage_name(m_stage);
+
+            if(m_initializer >= 0) s += "[initializer " + boost::lexical_cast<std::string>(m_initializer) + "]";
+            if(m_context[0]      ) s += std::string(" ") + m_context;
+
+            return s;
+        }
+    };
+
+    BOOST_STATIC_ASSERT(sizeof(launch_report) <= PIPE_BUF);
+
+    /// Exception thrown in the parent when the child reported a launch_report.
+    class launch_error : public boost::system::system_error
+    {
+    public:
+        explicit launch_error(const launch_report& r)
+        : boost::system::system_error(r.code(), r.describe()), m_report(r) {}
+
+        explicit launch_error(const boost::system::error_code& ec)
+        : boost::system::system_error(ec), m_report()
+        {
+            m_report.assign(launch_report::no_stage, -1, ec.value(), 0, 0);
+        }
+
+        int         stage      () const { return m_report.m_stage;       }
+        int         initializer() const { return m_report.m_initializer; }
+        const char* context    () const { return m_report.m_context;     }
+
+        const launch_report& report() const { return m_report; }
+
+    private:
+        launch_report m_report;
+    };
+
+    /// Builds the exception thrown by throw_on_launch_error<EXC>. User supplied exception
+    /// types only need to be constructible from an error_code.
+    template<class EXC> struct launch_exception
+    {
+        static EXC make(const launch_report& r) { return EXC(r.code()); }
+    };
+
+    template<> struct launch_exception<launch_error>
+    {
+        static launch_error make(const launch_report& r) { return launch_error(r); }
+    };
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_LAUNCH_ERROR_HPP
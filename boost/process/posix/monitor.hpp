@@ -9,17 +9,45 @@
 #define BOOST_PROCESS_POSIX_MONITOR_HPP
 
 #include "boost/process/posix/child.hpp"
+#include "boost/process/posix/exit_status.hpp"
+#include "boost/process/posix/pidfd.hpp"
+#include "boost/process/posix/reaper.hpp"
+#include "boost/process/posix/termination_policy.hpp"
+#include <boost/process/expected.hpp>
+#include <boost/chrono/duration.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/chrono/time_point.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/optional.hpp>
 
+#include <boost/system/system_error.hpp>
+
+#include <cerrno>
+
+#include <pthread.h>
 #include <signal.h>
 #include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
 
 namespace boost { namespace process { namespace posix {
 
     struct monitor 
     {
-        monitor(const child& c) : m_id(c.handle()) {}
+        monitor(const child& c) : m_id(c.handle()), m_reaped(false) {}
+
+        exit_status join() const
+        {
+            boost::system::error_code ec;
+            exit_status status = join(ec);
+            throw_if(ec);
+
+            return status;
+        }
 
-        int join() const
+        /// As join(), but reports a failed waitpid in ec, with a default exit_status, instead
+        /// of throwing.
+        exit_status join(boost::system::error_code& ec) const
         {
             int     status = 0;
             pid_t wait_val = 0;
@@ -32,33 +60,320 @@ namespace boost { namespace process { namespace posix {
 
             if(wait_val == -1)
             {
-                throw boost::system::system_error(boost::system::error_code(errno, boost::system::system_category()));
+                if(errno == ECHILD) m_reaped = true; // by someone else
+                ec.assign(errno, boost::system::system_category());
+                return exit_status();
             }
             
-            return status;
+            m_reaped = true;
+            ec.clear();
+            return exit_status(status);
+        }
+
+        /// join() with the error in the result instead of an exception.
+        expected<exit_status> join_expected() const
+        {
+            boost::system::error_code ec;
+            exit_status status = join(ec);
+
+            return ec? expected<exit_status>(ec) : expected<exit_status>(status);
         }
 
         template<class EXC> void join() const
         {
-            if(join()) throw EXC();
+            if(!join().success()) throw EXC();
         }
 
+        /// Waits at most d for the child to exit and returns its status, or none if it is
+        /// still running. Blocks only the calling thread, on the child's pidfd where there is
+        /// one, otherwise on SIGCHLD; no thread is started.
+        template<class Rep, class Period>
+        boost::optional<exit_status> join_for(const boost::chrono::duration<Rep, Period>& d) const
+        {
+            return join_until(boost::chrono::steady_clock::now() + d);
+        }
+
+        /// Waits until t for the child to exit. The time left is taken against Clock once,
+        /// the wait itself runs on CLOCK_MONOTONIC, so clock changes do not move it.
+        template<class Clock, class Duration>
+        boost::optional<exit_status> join_until(const boost::chrono::time_point<Clock, Duration>& t) const
+        {
+            const long long left = boost::chrono::duration_cast<boost::chrono::nanoseconds>(t - Clock::now()).count();
+            const timespec deadline = monotonic_after(left > 0? left : 0);
+
+            const int fd = pidfd::open(m_id); // -1: wait for SIGCHLD instead
+
+            int  status = 0;
+            boost::system::error_code ec;
+            bool reaped = try_join_until(fd, &deadline, status, ec);
+
+            if(fd != -1) close(fd);
+            throw_if(ec);
+
+            if(!reaped) return boost::none;
+
+            return exit_status(status);
+        }
+
+        /// Kills the child at once, without waiting for it. See terminate(const termination_policy&)
+        /// for a graceful end.
         void terminate() const
         {
-            if(kill(m_id, SIGKILL) == -1)    //: SIGTERM
+            boost::system::error_code ec;
+            terminate(ec);
+            throw_if(ec);
+        }
+
+        /// As terminate(), reporting a failed kill in ec instead of throwing.
+        void terminate(boost::system::error_code& ec) const
+        {
+            if(kill(m_id, SIGKILL) == -1) ec.assign(errno, boost::system::system_category());
+            else                          ec.clear();
+        }
+
+        /// Sends the policy's signals until the child exits and returns its status once it
+        /// is reaped. Blocks only the calling thread, on the child's pidfd where there is one.
+        exit_status terminate(const termination_policy& p) const
+        {
+            boost::system::error_code ec;
+            exit_status status = terminate(p, ec);
+            throw_if(ec);
+
+            return status;
+        }
+
+        /// As terminate(p), reporting a failed signal or wait in ec, with a default exit_status,
+        /// instead of throwing.
+        exit_status terminate(const termination_policy& p, boost::system::error_code& ec) const
+        {
+            const int fd = pidfd::open(m_id); // -1: poll instead
+
+            int  status = 0;
+            bool reaped = false;
+
+            ec.clear();
+            for(termination_policy::steps_type::const_iterator s = p.m_steps.begin(); !ec && !reaped && s != p.m_steps.end(); ++s)
             {
-                throw boost::system::system_error(boost::system::error_code(errno, boost::system::system_category()));
+                if(p.send(m_id, fd, s->m_signal) == -1 && errno != ESRCH)
+                {
+                    ec.assign(errno, boost::system::system_category());
+                    break;
+                }
+                reaped = try_join(fd, s->m_grace_ms, status, ec);
             }
+            if(!ec && !reaped) reaped = try_join(fd, -1, status, ec);
+
+            if(fd != -1) close(fd);
+            if(ec) return exit_status();
+
+            p.sweep_process_group(m_id);
+
+            return exit_status(status);
+        }
+
+        /// terminate(p) with the error in the result instead of an exception.
+        expected<exit_status> terminate_expected(const termination_policy& p) const
+        {
+            boost::system::error_code ec;
+            exit_status status = terminate(p, ec);
+
+            return ec? expected<exit_status>(ec) : expected<exit_status>(status);
         }
         
-        pid_t m_id;
-        
+        pid_t        m_id;
+        mutable bool m_reaped; // by a join or terminate through any monitor& to this one, or found gone
+
+    protected:
+        enum { sigchld_slice_ns = 10000000 };
+
+        /// Waits up to timeout_ms milliseconds, -1 for no limit, and reaps the child.
+        /// Returns false on timeout.
+        bool try_join(int fd, int timeout_ms, int& status) const
+        {
+            boost::system::error_code ec;
+            bool reaped = try_join(fd, timeout_ms, status, ec);
+            throw_if(ec);
+
+            return reaped;
+        }
+
+        bool try_join(int fd, int timeout_ms, int& status, boost::system::error_code& ec) const
+        {
+            if(timeout_ms < 0) return try_join_until(fd, 0, status, ec);
+
+            const timespec deadline = monotonic_after(timeout_ms * 1000000LL);
+
+            return try_join_until(fd, &deadline, status, ec);
+        }
+
+        /// Waits until deadline on CLOCK_MONOTONIC, 0 for no limit, on the child's pidfd, or
+        /// without one on SIGCHLD, and reaps the child. Returns false on timeout.
+        bool try_join_until(int fd, const timespec* deadline, int& status) const
+        {
+            boost::system::error_code ec;
+            bool reaped = try_join_until(fd, deadline, status, ec);
+            throw_if(ec);
+
+            return reaped;
+        }
+
+        /// Returns false on timeout and on failure, with ec set.
+        bool try_join_until(int fd, const timespec* deadline, int& status, boost::system::error_code& ec) const
+        {
+            ec.clear();
+            if(fd == -1) return try_join_sigchld(deadline, status, ec);
+
+            for(;;)
+            {
+                timespec left = { 0, 0 };
+                if(deadline) time_left(*deadline, left);
+
+                int r = pidfd::wait_exited(fd, deadline? &left : 0);
+                if(r == 1) break;
+                if(r == 0) return false;
+                if(errno != EINTR)
+                {
+                    ec.assign(errno, boost::system::system_category());
+                    return false;
+                }
+            }
+
+            status = join(ec).native();
+            return !ec;
+        }
+
+        /// Without a pidfd: blocks SIGCHLD in the calling thread and sleeps in sigtimedwait
+        /// between checks. A SIGCHLD taken by another thread or a handler is not seen here,
+        /// so no single sleep is longer than sigchld_slice_ns. Consumes pending SIGCHLDs.
+        bool try_join_sigchld(const timespec* deadline, int& status, boost::system::error_code& ec) const
+        {
+#if defined(__linux__)
+            sigset_t chld, old;
+            sigemptyset(&chld);
+            sigaddset(&chld, SIGCHLD);
+            pthread_sigmask(SIG_BLOCK, &chld, &old);
+#endif
+
+            bool reaped = false;
+            int  error  = 0;
+            for(;;)
+            {
+                pid_t p = waitpid(m_id, &status, WNOHANG);
+                if(p == m_id) { reaped = m_reaped = true; break; }
+                if(p == -1 && errno != EINTR) { error = errno; m_reaped = (errno == ECHILD); break; }
+
+                timespec slice = { 0, sigchld_slice_ns };
+                if(deadline)
+                {
+                    timespec left;
+                    if(!time_left(*deadline, left)) break;
+                    if(left.tv_sec == 0 && left.tv_nsec < slice.tv_nsec) slice = left;
+                }
+
+#if defined(__linux__)
+                sigtimedwait(&chld, 0, &slice);
+#else
+                if(slice.tv_nsec > 1000000) slice.tv_nsec = 1000000;
+                nanosleep(&slice, 0);
+#endif
+            }
+
+#if defined(__linux__)
+            pthread_sigmask(SIG_SETMASK, &old, 0);
+#endif
+
+            if(error) ec.assign(error, boost::system::system_category());
+
+            return reaped;
+        }
+
+        static void throw_if(const boost::system::error_code& ec)
+        {
+            if(ec) throw boost::system::system_error(ec);
+        }
+
+        static timespec monotonic_after(long long ns)
+        {
+            timespec t;
+            clock_gettime(CLOCK_MONOTONIC, &t);
+
+            ns += t.tv_nsec;
+            t.tv_sec  += time_t(ns / 1000000000);
+            t.tv_nsec  = long(ns % 1000000000);
+
+            return t;
+        }
+
+        /// Time from now until deadline; false and zero once it passed.
+        static bool time_left(const timespec& deadline, timespec& left)
+        {
+            timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+
+            long long ns = (long long)(deadline.tv_sec - now.tv_sec) * 1000000000 + (deadline.tv_nsec - now.tv_nsec);
+            if(ns <= 0) ns = 0;
+
+            left.tv_sec  = time_t(ns / 1000000000);
+            left.tv_nsec = long(ns % 1000000000);
+
+            return ns > 0;
+        }
+
+    public:
         //variant<uninitialized, joinable, variant<completed, failed> > m_state;
     };
 
-    struct scoped_monitor : public monitor
+    /// Monitor that does not let its child go unreaped: unless the child was reaped through
+    /// it, also through a monitor& to it, or released, the destructor applies the exit policy.
+    ///
+    /// join_on_exit and terminate_on_exit block until the child is gone. detach_on_exit
+    /// hands it to the background reaper and terminate_detached, the default, has the
+    /// reaper end it with the termination policy first; both only queue the child.
+    ///
+    /// \code
+    ///     bp::posix::scoped_monitor m(bp::make_child(bp::paths(exe)));
+    ///     might_throw();
+    ///     int status = m.join();
+    /// \endcode
+    struct scoped_monitor : public monitor, private boost::noncopyable
     {
-        scoped_monitor(const child& c) : monitor(c) {}
+        enum exit_policy { join_on_exit, terminate_on_exit, detach_on_exit, terminate_detached };
+
+        explicit scoped_monitor(const child& c, exit_policy e = terminate_detached, const termination_policy& p = termination_policy())
+            : monitor(c), m_exit_policy(e), m_policy(p)
+        {
+            m_reaped = !c;
+        }
+
+        ~scoped_monitor()
+        {
+            if(m_reaped) return;
+
+            try
+            {
+                switch(m_exit_policy)
+                {
+                case join_on_exit:       monitor::join();                          break;
+                case terminate_on_exit:  monitor::terminate(m_policy);             break;
+                case detach_on_exit:     reaper::instance().add(m_id);             break;
+                case terminate_detached: reaper::instance().add(m_id, m_policy);   break;
+                }
+            }
+            catch(...)
+            {
+            }
+        }
+
+        /// Gives up the child, the destructor then leaves it alone.
+        child release()
+        {
+            m_reaped = true;
+
+            return child(m_id);
+        }
+
+        exit_policy        m_exit_policy;
+        termination_policy m_policy;
     };
 
     template<class EXC> inline void join(const monitor& m)
@@ -0,0 +1,360 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_MONITOR_GROUP_HPP
+#define BOOST_PROCESS_POSIX_MONITOR_GROUP_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/child.hpp>
+#include <boost/process/posix/detail/helpers.hpp>
+#include <boost/process/posix/exit_status.hpp>
+#include <boost/process/posix/pidfd.hpp>
+#include <boost/process/posix/termination_policy.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#if !defined(__linux__)
+#   error "monitor_group requires Linux (epoll, eventfd and pidfds)"
+#endif
+
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace boost { namespace process { namespace posix {
+
+    /// Waits for any or all of many children at once.
+    ///
+    /// Every child's pidfd is in one epoll set, so a wait only touches the children that
+    /// exited, however many are monitored, and reaps all of them it finds in one go. On
+    /// kernels without pidfds the group polls its children every poll_interval_ms instead.
+    /// cancel() may be called from any other thread to end a wait early.
+    ///
+    /// \code
+    ///     bp::posix::monitor_group g;
+    ///     for(int i = 0; i < n; ++i) g.add(bp::make_child(bp::paths(exe)));
+    ///     std::vector<bp::posix::monitor_group::result> done;
+    ///     if(g.wait_all_or_kill(done) == bp::posix::monitor_group::completed) ...
+    /// \endcode
+    class monitor_group : private boost::noncopyable
+    {
+    public:
+        struct result
+        {
+            pid_t       m_pid;
+            exit_status m_status;
+        };
+
+        enum wait_result { completed, timed_out, cancelled };
+
+        enum { poll_interval_ms = 10 };
+
+        monitor_group() : m_epoll(::epoll_create1(EPOLL_CLOEXEC)), m_cancel(-1), m_use_pidfds(true), m_waitid_pidfd(true), m_running(0), m_members()
+        {
+            if(m_epoll == -1) detail::throw_last_error();
+
+            m_cancel = ::eventfd(0, EFD_CLOEXEC|EFD_NONBLOCK);
+            if(m_cancel == -1) { close(m_epoll); detail::throw_last_error(); }
+
+            epoll_event ev;
+            std::memset(&ev, 0, sizeof(ev));
+            ev.events   = EPOLLIN;
+            ev.data.u32 = cancel_key;
+            if(::epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_cancel, &ev) == -1) { close(m_cancel); close(m_epoll); detail::throw_last_error(); }
+        }
+
+        ~monitor_group()
+        {
+            for(std::size_t i = 0; i < m_members.size(); ++i) if(m_members[i].m_pidfd != -1) close(m_members[i].m_pidfd);
+
+            close(m_cancel);
+            close(m_epoll);
+        }
+
+        void add(const child& c)
+        {
+            member m = { c.handle(), -1, true };
+
+            if(m_use_pidfds)
+            {
+                m.m_pidfd = pidfd::open(m.m_pid);
+                if(m.m_pidfd == -1)
+                {
+                    if(errno != ENOSYS) detail::throw_last_error();
+                    use_polling();
+                }
+            }
+            if(m.m_pidfd != -1)
+            {
+                epoll_event ev;
+                std::memset(&ev, 0, sizeof(ev));
+                ev.events   = EPOLLIN;
+                ev.data.u32 = boost::uint32_t(m_members.size());
+                if(::epoll_ctl(m_epoll, EPOLL_CTL_ADD, m.m_pidfd, &ev) == -1) { close(m.m_pidfd); detail::throw_last_error(); }
+            }
+
+            m_members.push_back(m);
+            ++m_running;
+        }
+
+        /// Number of children added.
+        std::size_t size() const { return m_members.size(); }
+
+        /// Number of children not reaped yet.
+        std::size_t running() const { return m_running; }
+
+        /// Waits up to timeout_ms milliseconds, -1 for no limit, until at least one child
+        /// exited, and appends all exited children to out.
+        wait_result wait_any(std::vector<result>& out, int timeout_ms = -1)
+        {
+            const long long deadline = deadline_of(timeout_ms);
+
+            std::size_t before = out.size();
+            while(out.size() == before && m_running)
+            {
+                wait_result r = wait_once(out, remaining(deadline));
+                if(r != completed) return r;
+            }
+            return completed;
+        }
+
+        /// Waits up to timeout_ms milliseconds, -1 for no limit, until all children exited,
+        /// appending them to out as they do. On timeout the ones still running stay in the group.
+        wait_result wait_all(std::vector<result>& out, int timeout_ms = -1)
+        {
+            const long long deadline = deadline_of(timeout_ms);
+
+            while(m_running)
+            {
+                wait_result r = wait_once(out, remaining(deadline));
+                if(r != completed) return r;
+            }
+            return completed;
+        }
+
+        /// As wait_all, but as soon as one child exits with a status other than 0, all
+        /// others are sent sig, and are still reaped.
+        wait_result wait_all_or_kill(std::vector<result>& out, int sig = SIGKILL, int timeout_ms = -1)
+        {
+            const long long deadline = deadline_of(timeout_ms);
+
+            bool killed = false;
+            while(m_running)
+            {
+                std::size_t before = out.size();
+
+                wait_result r = wait_once(out, remaining(deadline));
+                if(r != completed) return r;
+
+                for(std::size_t i = before; !killed && i < out.size(); ++i)
+                {
+                    if(!out[i].m_status.success()) { signal_all(sig); killed = true; }
+                }
+            }
+            return completed;
+        }
+
+        /// Sends sig to every child not reaped yet, through its pidfd where there is one, so a
+        /// recycled pid is never hit.
+        void signal_all(int sig)
+        {
+            for(std::size_t i = 0; i < m_members.size(); ++i)
+            {
+                const member& m = m_members[i];
+                if(!m.m_running) continue;
+
+                if(m.m_pidfd != -1) pidfd::send_signal(m.m_pidfd, sig);
+                else                ::kill(m.m_pid, sig);
+            }
+        }
+
+        /// Ends all children with the policy's signals, stepping all of them through the
+        /// sequence together: a step's signal goes to every child still running, then the
+        /// group waits up to the step's grace period for all to exit. Shutting down
+        /// thousands of children takes the same steps as shutting down one.
+        wait_result terminate(const termination_policy& p, std::vector<result>& out)
+        {
+            const std::size_t first = out.size();
+
+            wait_result r = completed;
+            for(termination_policy::steps_type::const_iterator s = p.m_steps.begin(); m_running && s != p.m_steps.end(); ++s)
+            {
+                for(std::size_t i = 0; i < m_members.size(); ++i)
+                {
+                    if(m_members[i].m_running) p.send(m_members[i].m_pid, m_members[i].m_pidfd, s->m_signal);
+                }
+                if((r = wait_all(out, s->m_grace_ms)) == cancelled) return r;
+            }
+            if(m_running && (r = wait_all(out)) == cancelled) return r;
+
+            for(std::size_t i = first; i < out.size(); ++i) p.sweep_process_group(out[i].m_pid);
+
+            return completed;
+        }
+
+        /// Ends the current wait, or the next one if none is in progress, with cancelled.
+        /// Can be called from any thread.
+        void cancel()
+        {
+            boost::uint64_t one = 1;
+            ssize_t n = ::write(m_cancel, &one, sizeof(one));
+            (void)n;
+        }
+
+    private:
+        enum { cancel_key = 0xffffffffu, max_events = 64 };
+
+        struct member
+        {
+            pid_t m_pid;
+            int   m_pidfd;   // -1 while polling
+            bool  m_running;
+        };
+
+        /// One epoll_wait, reaping every child that became ready.
+        wait_result wait_once(std::vector<result>& out, int timeout_ms)
+        {
+            if(!m_use_pidfds)
+            {
+                std::size_t before = out.size();
+                for(std::size_t i = 0; i < m_members.size(); ++i) if(m_members[i].m_running) reap(i, out);
+                if(out.size() != before) return completed;
+
+                if(timeout_ms == -1 || timeout_ms > poll_interval_ms) timeout_ms = poll_interval_ms;
+            }
+
+            epoll_event events[max_events];
+
+            int n = ::epoll_wait(m_epoll, events, max_events, timeout_ms);
+            if(n == -1)
+            {
+                if(errno == EINTR) return completed;
+                detail::throw_last_error();
+            }
+
+            bool cancel_requested = false;
+            for(int i = 0; i < n; ++i)
+            {
+                if(events[i].data.u32 == cancel_key) cancel_requested = true;
+                else reap(events[i].data.u32, out);
+            }
+            if(cancel_requested)
+            {
+                boost::uint64_t count;
+                ssize_t r = ::read(m_cancel, &count, sizeof(count));
+                (void)r;
+                return cancelled;
+            }
+
+            // polling mode ends its timeout at every interval, the caller checks the deadline
+            return (n == 0 && timeout_ms == 0)? timed_out : completed;
+        }
+
+        void reap(std::size_t i, std::vector<result>& out)
+        {
+            member& m = m_members[i];
+
+            exit_status status;
+            int reaped = (m.m_pidfd != -1)? reap_pidfd(m, status) : -1;
+            if(reaped == 0) return;
+            if(reaped == -1)
+            {
+                int raw = 0;
+                pid_t p;
+                do
+                {
+                    p = ::waitpid(m.m_pid, &raw, WNOHANG);
+                }
+                while(p == -1 && errno == EINTR);
+
+                if(p == 0) return; // still running, only in polling mode
+                if(p == -1) detail::throw_last_error();
+
+                status = exit_status(raw);
+            }
+
+            if(m.m_pidfd != -1)
+            {
+                ::epoll_ctl(m_epoll, EPOLL_CTL_DEL, m.m_pidfd, 0);
+                close(m.m_pidfd);
+                m.m_pidfd = -1;
+            }
+            m.m_running = false;
+            --m_running;
+
+            result r = { m.m_pid, status };
+            out.push_back(r);
+        }
+
+        /// Reaps through the pidfd, so the status comes decoded in siginfo_t. Returns 1 once
+        /// reaped, 0 if still running and -1 if the kernel cannot, to use waitpid instead.
+        int reap_pidfd(const member& m, exit_status& status)
+        {
+            if(!m_waitid_pidfd) return -1;
+
+            siginfo_t info;
+            std::memset(&info, 0, sizeof(info));
+
+            int r;
+            while((r = pidfd::wait(m.m_pidfd, info, WEXITED|WNOHANG)) == -1 && errno == EINTR) {}
+
+            if(r == -1)
+            {
+                if(errno != EINVAL) detail::throw_last_error();
+                m_waitid_pidfd = false;
+                return -1;
+            }
+            if(info.si_pid == 0) return 0;
+
+            status = exit_status(info);
+            return 1;
+        }
+
+        /// Without pidfds for one child all are polled, the group does not mix both.
+        void use_polling()
+        {
+            m_use_pidfds = false;
+
+            for(std::size_t i = 0; i < m_members.size(); ++i)
+            {
+                member& m = m_members[i];
+                if(m.m_pidfd == -1) continue;
+
+                ::epoll_ctl(m_epoll, EPOLL_CTL_DEL, m.m_pidfd, 0);
+                close(m.m_pidfd);
+                m.m_pidfd = -1;
+            }
+        }
+
+        static long long deadline_of(int timeout_ms) { return (timeout_ms < 0)? -1 : detail::now_ms() + timeout_ms; }
+
+        static int remaining(long long deadline)
+        {
+            if(deadline == -1) return -1;
+
+            long long left = deadline - detail::now_ms();
+
+            return (left > 0)? int(left) : 0;
+        }
+
+        int                 m_epoll;
+        int                 m_cancel;    // eventfd, readable after cancel()
+        bool                m_use_pidfds;
+        bool                m_waitid_pidfd; // false once waitid(P_PIDFD) failed
+        std::size_t         m_running;
+        std::vector<member> m_members;
+    };
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_MONITOR_GROUP_HPP
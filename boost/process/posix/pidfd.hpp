@@ -0,0 +1,93 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_PIDFD_HPP
+#define BOOST_PROCESS_POSIX_PIDFD_HPP
+
+#include <boost/process/config.hpp>
+
+#include <cerrno>
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#   include <sys/syscall.h>
+#endif
+
+namespace boost { namespace process { namespace posix {
+
+    /// Process file descriptor (Linux 5.3 and later): becomes readable when the process
+    /// exits and signals it without the risk of hitting a recycled pid. On other systems
+    /// and older kernels open() fails with ENOSYS and the callers fall back to plain pids.
+    struct pidfd
+    {
+        typedef int file_descriptor_type;
+
+        /// The fd is close-on-exec. Returns -1 with errno set on failure.
+        static file_descriptor_type open(pid_t pid)
+        {
+#if defined(__linux__) && defined(SYS_pidfd_open)
+            return file_descriptor_type(::syscall(SYS_pidfd_open, pid, 0));
+#else
+            (void)pid; errno = ENOSYS; return -1;
+#endif
+        }
+
+        /// Returns -1 with errno set on failure.
+        static int send_signal(file_descriptor_type fd, int sig)
+        {
+#if defined(__linux__) && defined(SYS_pidfd_send_signal)
+            return int(::syscall(SYS_pidfd_send_signal, fd, sig, 0, 0));
+#else
+            (void)fd; (void)sig; errno = ENOSYS; return -1;
+#endif
+        }
+
+        /// Waits up to timeout_ms milliseconds, -1 for no limit, for the process to exit.
+        /// Returns 1 once it exited, 0 on timeout and -1 with errno set on failure.
+        static int wait_exited(file_descriptor_type fd, int timeout_ms)
+        {
+            pollfd p = { fd, POLLIN, 0 };
+
+            int n = ::poll(&p, 1, timeout_ms);
+
+            return (n > 0)? 1 : n;
+        }
+
+        /// As above, with the timeout in nanoseconds, 0 for no limit. On Linux ppoll keeps the
+        /// wake-up within the timer slack instead of rounding up to whole milliseconds.
+        static int wait_exited(file_descriptor_type fd, const timespec* timeout)
+        {
+            pollfd p = { fd, POLLIN, 0 };
+
+#if defined(__linux__)
+            int n = ::ppoll(&p, 1, timeout, 0);
+#else
+            int n = ::poll(&p, 1, timeout? int(timeout->tv_sec * 1000 + (timeout->tv_nsec + 999999) / 1000000) : -1);
+#endif
+
+            return (n > 0)? 1 : n;
+        }
+
+        /// waitid on the process itself instead of its pid (Linux 5.4 and later). Returns -1
+        /// with errno set on failure, EINVAL on kernels that have pidfds but not this.
+        static int wait(file_descriptor_type fd, siginfo_t& info, int options)
+        {
+#if defined(__linux__)
+            return ::waitid(idtype_t(3), id_t(fd), &info, options); // P_PIDFD, missing in older headers
+#else
+            (void)fd; (void)info; (void)options; errno = ENOSYS; return -1;
+#endif
+        }
+    };
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_PIDFD_HPP
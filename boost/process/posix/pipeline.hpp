@@ -0,0 +1,173 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_PIPELINE_HPP
+#define BOOST_PROCESS_POSIX_PIPELINE_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/child.hpp>
+#include <boost/process/posix/detail/helpers.hpp>
+#include <boost/process/posix/monitor.hpp>
+#include <boost/process/posix/initializers/initializer.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <cerrno>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace boost { namespace process { namespace posix {
+
+    /// Joins all stages of a pipeline.
+    struct pipeline_monitor
+    {
+        explicit pipeline_monitor(const std::vector<child>& stages) : m_stages(stages) {}
+
+        /// Joins every stage and returns the status of the last one, like a shell does.
+        exit_status join() const
+        {
+            std::vector<exit_status> s = join_all();
+
+            return s.empty()? exit_status() : s.back();
+        }
+
+        /// Joins every stage and returns their statuses in stage order.
+        std::vector<exit_status> join_all() const
+        {
+            std::vector<exit_status> statuses;
+            statuses.reserve(m_stages.size());
+
+            for(std::size_t i = 0; i < m_stages.size(); ++i) statuses.push_back(monitor(m_stages[i]).join());
+
+            return statuses;
+        }
+
+        std::vector<child> m_stages;
+    };
+
+    /// Connects the stdout of each child to the stdin of the next one with a kernel pipe,
+    /// like a shell's "a | b | c". The data never passes through the parent.
+    ///
+    /// Each stage is launched by make_child with an initializer from stage(), the final one
+    /// with last_stage(), whose stdout is left to the other initializers. The parent keeps
+    /// no pipe end open once a stage is launched, so every stage sees EOF when the one before
+    /// it exits.
+    ///
+    /// \code
+    ///     bp::posix::pipeline p;
+    ///     bp::make_child(bp::paths("/usr/bin/head"), bp::args("-c")("1000"), p.stage());
+    ///     bp::make_child(bp::paths("/bin/cat"), p.stage());
+    ///     bp::make_child(bp::paths("/usr/bin/wc"), bp::std_out_to(ray), p.last_stage());
+    ///     int status = p.monitor().join();
+    /// \endcode
+    class pipeline : private boost::noncopyable
+    {
+    public:
+        typedef int file_descriptor_type;
+
+        struct stage_initializer : public initializer
+        {
+            // a child can only be one stage
+            typedef initializer_combination::exclusive combination_category;
+            typedef child_memory::shared child_memory_category;
+
+            explicit stage_initializer(pipeline& p) : m_pipeline(p) {}
+
+            template<class Executor> void post_fork_child(Executor& e) const
+            {
+                if(m_pipeline.m_stage_in  != -1) e.set_std_in (m_pipeline.m_stage_in );
+                if(m_pipeline.m_stage_out != -1) e.set_std_out(m_pipeline.m_stage_out);
+            }
+
+            template<class Executor> void post_fork_parent(Executor& e) const
+            {
+                m_pipeline.m_stages.push_back(child(e.m_pid));
+                m_pipeline.close_stage_ends();
+            }
+
+            template<class Executor> void failed_fork_parent(Executor&) const
+            {
+                m_pipeline.close_stage_ends();
+            }
+
+            pipeline& m_pipeline;
+        };
+
+        /// With a pipe_size other than 0 each pipe's buffer is resized to it, where supported.
+        explicit pipeline(int pipe_size = 0) : m_pipe_size(pipe_size), m_stage_in(-1), m_stage_out(-1), m_next_in(-1), m_stages() {}
+
+        ~pipeline()
+        {
+            close_stage_ends();
+            close_end(m_next_in);
+        }
+
+        /// Initializer for a stage whose stdout feeds the next stage.
+        stage_initializer stage()
+        {
+            close_stage_ends(); // of a stage whose launch failed
+
+            file_descriptor_type pipe_fds[2] = {-1, -1};
+
+#if defined(__linux__)
+            if(::pipe2(pipe_fds, O_CLOEXEC) == -1) detail::throw_last_error();
+#else
+            if(::pipe(pipe_fds) == -1) detail::throw_last_error();
+
+            fcntl(pipe_fds[0], F_SETFD, FD_CLOEXEC);
+            fcntl(pipe_fds[1], F_SETFD, FD_CLOEXEC);
+#endif
+
+#if defined(F_SETPIPE_SZ)
+            // only a hint, the kernel may cap it
+            if(m_pipe_size) fcntl(pipe_fds[1], F_SETPIPE_SZ, m_pipe_size);
+#endif
+
+            m_stage_in  = m_next_in;
+            m_stage_out = pipe_fds[1];
+            m_next_in   = pipe_fds[0];
+
+            return stage_initializer(*this);
+        }
+
+        /// Initializer for the final stage, which only reads from the stage before it.
+        stage_initializer last_stage()
+        {
+            close_stage_ends();
+
+            m_stage_in = m_next_in;
+            m_next_in  = -1;
+
+            return stage_initializer(*this);
+        }
+
+        const std::vector<child>& stages() const { return m_stages; }
+
+        pipeline_monitor monitor() const { return pipeline_monitor(m_stages); }
+
+    private:
+        static void close_end(file_descriptor_type& fd)
+        {
+            if(fd != -1) { close(fd); fd = -1; }
+        }
+
+        void close_stage_ends()
+        {
+            close_end(m_stage_in );
+            close_end(m_stage_out);
+        }
+
+        int                  m_pipe_size;
+        file_descriptor_type m_stage_in;  // ends used by the stage being launched
+        file_descriptor_type m_stage_out;
+        file_descriptor_type m_next_in;   // read end for the stage after it
+        std::vector<child>   m_stages;
+    };
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_PIPELINE_HPP
@@ -0,0 +1,171 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_PROCESS_GROUP_MONITOR_HPP
+#define BOOST_PROCESS_POSIX_PROCESS_GROUP_MONITOR_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/child.hpp>
+#include <boost/process/posix/detail/helpers.hpp>
+#include <boost/process/posix/exit_status.hpp>
+#include <boost/process/posix/termination_policy.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <pthread.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#   include <sys/prctl.h>
+#endif
+
+namespace boost { namespace process { namespace posix {
+
+    /// Signals and reaps a whole process group, as started with new_process_group,
+    /// join_process_group or new_session: one kill(-pgid) reaches every process in it,
+    /// however deep the tree, and waitid(P_PGID) reaps all children of this process in it.
+    ///
+    /// Descendants of the children are reaped by their own parents. Once those are gone they
+    /// would go to init; after adopt_orphans() they come to this process instead and the
+    /// group's joins reap them as well.
+    ///
+    /// \code
+    ///     bp::child leader = bp::make_child(bp::paths("/bin/sh"), bp::args("-c")(script), bp::posix::new_process_group());
+    ///     std::vector<bp::posix::process_group_monitor::result> statuses;
+    ///     bp::posix::process_group_monitor(leader).terminate(bp::posix::termination_policy(), statuses);
+    /// \endcode
+    struct process_group_monitor
+    {
+        struct result
+        {
+            pid_t       m_pid;
+            exit_status m_status;
+        };
+
+        enum { sigchld_slice_ms = 10 };
+
+        explicit process_group_monitor(pid_t pgid) : m_pgid(pgid) {}
+        explicit process_group_monitor(const child& leader) : m_pgid(leader.handle()) {}
+
+        /// Sends sig to every process in the group. Returns false if none is left.
+        bool signal(int sig) const
+        {
+            if(::kill(-m_pgid, sig) == 0) return true;
+            if(errno == ESRCH)             return false;
+
+            detail::throw_last_error();
+            return false;
+        }
+
+        /// Reaps the group's children as they exit, appending them to out, until there are none.
+        void join(std::vector<result>& out) const
+        {
+            join(out, -1);
+        }
+
+        /// As above for up to timeout_ms milliseconds, -1 for no limit. Returns false if some
+        /// are still running.
+        bool join(std::vector<result>& out, int timeout_ms) const
+        {
+            const long long deadline = (timeout_ms < 0)? -1 : detail::now_ms() + timeout_ms;
+
+            // SIGCHLD stays blocked so sigtimedwait sees it; no single sleep is longer than
+            // sigchld_slice_ms, in case another thread takes it.
+            sigset_t chld, old;
+            sigemptyset(&chld);
+            sigaddset(&chld, SIGCHLD);
+            pthread_sigmask(SIG_BLOCK, &chld, &old);
+
+            bool done  = false;
+            int  error = 0;
+            for(;;)
+            {
+                if((error = reap_exited(out, done)) != 0 || done) break;
+
+                long long slice = sigchld_slice_ms;
+                if(deadline != -1)
+                {
+                    long long left = deadline - detail::now_ms();
+                    if(left <= 0) break;
+                    if(left < slice) slice = left;
+                }
+
+#if defined(__linux__)
+                timespec ts = { 0, long(slice * 1000000) };
+                sigtimedwait(&chld, 0, &ts);
+#else
+                timespec ts = { 0, 1000000 };
+                nanosleep(&ts, 0);
+#endif
+            }
+
+            pthread_sigmask(SIG_SETMASK, &old, 0);
+
+            if(error)
+            {
+                throw boost::system::system_error(boost::system::error_code(error, boost::system::system_category()));
+            }
+            return done;
+        }
+
+        /// Ends the group with the policy's signals, each sent to the group whether or not
+        /// the policy's to_process_group was set, and reaps the group's children.
+        void terminate(const termination_policy& p, std::vector<result>& out) const
+        {
+            for(termination_policy::steps_type::const_iterator s = p.m_steps.begin(); s != p.m_steps.end(); ++s)
+            {
+                if(!signal(s->m_signal)) break;
+                if(join(out, s->m_grace_ms)) return;
+            }
+            join(out);
+        }
+
+        /// Makes this process the child subreaper (Linux 3.4 and later): orphaned descendants
+        /// are reparented to it instead of to init. Affects the whole process. Returns false
+        /// where unsupported.
+        static bool adopt_orphans()
+        {
+#if defined(__linux__) && defined(PR_SET_CHILD_SUBREAPER)
+            return ::prctl(PR_SET_CHILD_SUBREAPER, 1, 0, 0, 0) == 0;
+#else
+            return false;
+#endif
+        }
+
+        pid_t m_pgid;
+
+    private:
+        /// Reaps every child in the group that exited; done once none is left. Returns an
+        /// errno value on failure.
+        int reap_exited(std::vector<result>& out, bool& done) const
+        {
+            for(;;)
+            {
+                siginfo_t info;
+                std::memset(&info, 0, sizeof(info));
+
+                if(::waitid(P_PGID, id_t(m_pgid), &info, WEXITED|WNOHANG) == -1)
+                {
+                    if(errno == EINTR) continue;
+                    if(errno == ECHILD) { done = true; return 0; }
+                    return errno;
+                }
+                if(info.si_pid == 0) return 0;
+
+                result r = { info.si_pid, exit_status(info) };
+                out.push_back(r);
+            }
+        }
+    };
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_PROCESS_GROUP_MONITOR_HPP
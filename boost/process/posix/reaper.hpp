@@ -0,0 +1,268 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_REAPER_HPP
+#define BOOST_PROCESS_POSIX_REAPER_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/detail/helpers.hpp>
+#include <boost/process/posix/pidfd.hpp>
+#include <boost/process/posix/termination_policy.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <cerrno>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace boost { namespace process { namespace posix {
+
+    /// Background thread that reaps children nobody waits for any more, optionally ending
+    /// them with a termination policy first. Handing a child over takes a lock and a write
+    /// to a pipe; signals, grace periods and waitpid all happen on the reaper's thread.
+    ///
+    /// There is one reaper per process, started on first use and never stopped. It waits on
+    /// the children's pidfds, on kernels without them it checks every poll_interval_ms.
+    class reaper : private boost::noncopyable
+    {
+    public:
+        enum { poll_interval_ms = 10 };
+
+        static reaper& instance() { return detail::leaked_singleton<reaper>::instance(); }
+
+        /// Reaps pid once it exits by itself.
+        void add(pid_t pid)
+        {
+            entry e = { pid, -1, false, termination_policy::steps_type(), false, 0, -1, true };
+            push(e);
+        }
+
+        /// Ends pid with the policy's signals, then reaps it.
+        void add(pid_t pid, const termination_policy& p)
+        {
+            entry e = { pid, -1, false, p.m_steps, p.m_process_group, 0, -1, true };
+            push(e);
+        }
+
+        /// Number of children handed over and not reaped yet.
+        std::size_t pending() const
+        {
+            pthread_mutex_lock(&m_mutex);
+            std::size_t n = m_pending;
+            pthread_mutex_unlock(&m_mutex);
+
+            return n;
+        }
+
+    private:
+        // lives as long as the process, as does its thread
+        friend class detail::leaked_singleton<reaper>;
+
+        struct entry
+        {
+            pid_t                          m_pid;
+            int                            m_pidfd;     // -1 while polling
+            bool                           m_gone;      // pidfd_open found no such process: never signalled
+            termination_policy::steps_type m_steps;     // empty: only reap
+            bool                           m_process_group;
+            std::size_t                    m_next_step;
+            long long                      m_deadline;  // of the current grace period, -1 for none
+            bool                           m_ready;     // may have exited, check with waitpid
+        };
+
+        reaper() : m_wake_read(-1), m_wake_write(-1), m_pending(0), m_incoming()
+        {
+            pthread_mutex_init(&m_mutex, 0);
+
+            int fds[2];
+#if defined(__linux__)
+            if(::pipe2(fds, O_CLOEXEC|O_NONBLOCK) == -1) detail::throw_last_error();
+#else
+            if(::pipe(fds) == -1) detail::throw_last_error();
+            for(int i = 0; i < 2; ++i)
+            {
+                fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+                fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+            }
+#endif
+            m_wake_read  = fds[0];
+            m_wake_write = fds[1];
+
+            // the thread must not take signals meant for the rest of the process
+            sigset_t all, old;
+            sigfillset(&all);
+            pthread_sigmask(SIG_SETMASK, &all, &old);
+
+            pthread_t thread;
+            int error = pthread_create(&thread, 0, &run, this);
+
+            pthread_sigmask(SIG_SETMASK, &old, 0);
+
+            if(error)
+            {
+                close(m_wake_read); close(m_wake_write);
+                throw boost::system::system_error(boost::system::error_code(error, boost::system::system_category()));
+            }
+            pthread_detach(thread);
+        }
+
+        void push(const entry& e)
+        {
+            pthread_mutex_lock(&m_mutex);
+            m_incoming.push_back(e);
+            ++m_pending;
+            pthread_mutex_unlock(&m_mutex);
+
+            char c = 0;
+            ssize_t n = ::write(m_wake_write, &c, 1); // full pipe: a wake-up is pending anyway
+            (void)n;
+        }
+
+        static void* run(void* self)
+        {
+            static_cast<reaper*>(self)->loop();
+            return 0;
+        }
+
+        void loop()
+        {
+            std::vector<entry>  entries;
+            std::vector<pollfd> fds;
+
+            for(;;)
+            {
+                pthread_mutex_lock(&m_mutex);
+                std::size_t first_new = entries.size();
+                entries.insert(entries.end(), m_incoming.begin(), m_incoming.end());
+                m_incoming.clear();
+                pthread_mutex_unlock(&m_mutex);
+
+                // a child reaped before it was handed over, e.g. through a monitor&, is dropped
+                // before any signal: its pid may belong to another process by now
+                std::size_t reaped = 0;
+                for(std::size_t i = first_new; i < entries.size(); )
+                {
+                    if(try_reap(entries[i]))
+                    {
+                        entries[i] = entries.back();
+                        entries.pop_back();
+                        ++reaped;
+                        continue;
+                    }
+
+                    entries[i].m_pidfd = pidfd::open(entries[i].m_pid);
+                    entries[i].m_gone  = entries[i].m_pidfd == -1 && errno == ESRCH;
+                    next_step(entries[i]);
+                    ++i;
+                }
+
+                for(std::size_t i = 0; i < entries.size(); )
+                {
+                    if((entries[i].m_ready || entries[i].m_pidfd == -1) && try_reap(entries[i]))
+                    {
+                        entries[i] = entries.back();
+                        entries.pop_back();
+                        ++reaped;
+                    }
+                    else ++i;
+                }
+                if(reaped)
+                {
+                    pthread_mutex_lock(&m_mutex);
+                    m_pending -= reaped;
+                    pthread_mutex_unlock(&m_mutex);
+                }
+
+                const long long now = detail::now_ms();
+
+                int  timeout_ms = -1;
+                bool polling    = false;
+                for(std::size_t i = 0; i < entries.size(); ++i)
+                {
+                    entry& e = entries[i];
+                    if(e.m_deadline != -1 && e.m_deadline <= now) next_step(e);
+                    if(e.m_deadline != -1)
+                    {
+                        int left = int(e.m_deadline - now);
+                        if(left < 0) left = 0;
+                        if(timeout_ms == -1 || left < timeout_ms) timeout_ms = left;
+                    }
+                    if(e.m_pidfd == -1) polling = true;
+                }
+                if(polling && (timeout_ms == -1 || timeout_ms > poll_interval_ms)) timeout_ms = poll_interval_ms;
+
+                fds.clear();
+                pollfd wake = { m_wake_read, POLLIN, 0 };
+                fds.push_back(wake);
+                for(std::size_t i = 0; i < entries.size(); ++i)
+                {
+                    if(entries[i].m_pidfd == -1) continue;
+                    pollfd p = { entries[i].m_pidfd, POLLIN, 0 };
+                    fds.push_back(p);
+                }
+
+                ::poll(&fds[0], nfds_t(fds.size()), timeout_ms);
+
+                for(std::size_t i = 0, k = 1; i < entries.size(); ++i)
+                {
+                    if(entries[i].m_pidfd != -1) entries[i].m_ready = fds[k++].revents != 0;
+                }
+
+                if(fds[0].revents)
+                {
+                    char buffer[64];
+                    while(::read(m_wake_read, buffer, sizeof(buffer)) > 0) {}
+                }
+            }
+        }
+
+        /// Sends the entry's next signal and starts its grace period.
+        static void next_step(entry& e)
+        {
+            e.m_deadline = -1;
+            if(e.m_next_step == e.m_steps.size()) return;
+
+            const termination_policy::step& s = e.m_steps[e.m_next_step++];
+
+            if(e.m_gone)             return; // try_reap drops it
+            if(e.m_process_group)    ::kill(-e.m_pid, s.m_signal);
+            else if(e.m_pidfd != -1) pidfd::send_signal(e.m_pidfd, s.m_signal);
+            else                     ::kill(e.m_pid, s.m_signal);
+
+            if(s.m_grace_ms != -1) e.m_deadline = detail::now_ms() + s.m_grace_ms;
+        }
+
+        /// True once the child is reaped, or was reaped by someone else.
+        static bool try_reap(entry& e)
+        {
+            int   status;
+            pid_t p;
+            while((p = ::waitpid(e.m_pid, &status, WNOHANG)) == -1 && errno == EINTR) {}
+
+            if(p == 0) return false;
+
+            if(p == e.m_pid && e.m_process_group && !e.m_steps.empty()) ::kill(-e.m_pid, e.m_steps.back().m_signal);
+            if(e.m_pidfd != -1) close(e.m_pidfd);
+
+            return true;
+        }
+
+        mutable pthread_mutex_t m_mutex;
+        int                     m_wake_read;  // written to on every add
+        int                     m_wake_write;
+        std::size_t             m_pending;
+        std::vector<entry>      m_incoming;   // handed over, not yet seen by the thread
+    };
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_REAPER_HPP
@@ -0,0 +1,389 @@
+
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_SHM_RAY_HPP
+#define BOOST_PROCESS_POSIX_SHM_RAY_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/detail/helpers.hpp>
+#include <boost/process/posix/initializers/initializer.hpp>
+#include <boost/process/posix/initializers/environment.hpp>
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#if !defined(__linux__)
+#   error "shm_ray requires Linux (memfd_create and futex)"
+#endif
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace boost { namespace process { namespace posix {
+
+    /// Single producer, single consumer message ring in memory shared between two processes.
+    ///
+    /// Messages are length prefixed and 8 byte aligned. Head and tail only grow, the
+    /// producer owns the head and the consumer the tail. Neither side makes a syscall
+    /// while the other keeps up: a side that has to block announces it in the control
+    /// block and sleeps on a futex, and the other side only wakes it when it announced so.
+    struct shm_ring
+    {
+        typedef boost::uint64_t    counter_type;
+        typedef boost::uint32_t       word_type;
+
+        BOOST_STATIC_ASSERT(sizeof(boost::atomic<counter_type>) == sizeof(counter_type));
+        BOOST_STATIC_ASSERT(sizeof(boost::atomic<word_type   >) == sizeof(word_type   ));
+
+        /// Lives at the start of each ring's part of the shared memory.
+        struct control
+        {
+            boost::atomic<counter_type> m_head; char m_pad0[64 - sizeof(counter_type)];
+            boost::atomic<counter_type> m_tail; char m_pad1[64 - sizeof(counter_type)];
+
+            boost::atomic<word_type> m_data_seq;          // futex the consumer sleeps on
+            boost::atomic<word_type> m_consumer_waiting;
+            boost::atomic<word_type> m_space_seq;         // futex the producer sleeps on
+            boost::atomic<word_type> m_producer_waiting;
+            boost::atomic<word_type> m_closed;            // set by the producer, no more messages
+            boost::atomic<word_type> m_stopped;           // set by the consumer, no more receives
+            char m_pad2[64 - 6 * sizeof(word_type)];
+        };
+
+        enum { wrap_marker = 0xffffffffu, header_size = sizeof(word_type) };
+
+        static std::size_t mapping_size(std::size_t capacity) { return sizeof(control) + capacity; }
+
+        shm_ring() : m_control(0), m_data(0), m_capacity(0) {}
+
+        void attach(void* mem, std::size_t capacity)
+        {
+            m_control  = static_cast<control*>(mem);
+            m_data     = static_cast<char*>(mem) + sizeof(control);
+            m_capacity = capacity;
+        }
+
+        std::size_t max_message_size() const { return m_capacity / 2 - 2 * header_size; }
+
+        /// Copies the message into the ring. Returns false if the ring is full.
+        bool try_send(const void* msg, std::size_t len)
+        {
+            if(len > max_message_size()) throw std::length_error("shm_ray: message larger than max_message_size()");
+
+            const counter_type head = m_control->m_head.load(boost::memory_order_relaxed);
+            const counter_type tail = m_control->m_tail.load(boost::memory_order_acquire);
+
+            const std::size_t pos        = std::size_t(head & (m_capacity - 1));
+            const std::size_t contiguous = m_capacity - pos;
+            const std::size_t record     = aligned(header_size + len);
+            const std::size_t required   = required_space(head, len);
+
+            if(m_capacity - std::size_t(head - tail) < required) return false;
+
+            std::size_t at = pos;
+            if(record > contiguous)
+            {
+                store_word(m_data + pos, wrap_marker);
+                at = 0;
+            }
+            std::memcpy(m_data + at + header_size, msg, len);
+            store_word(m_data + at, word_type(len));
+
+            m_control->m_head.store(head + required, boost::memory_order_seq_cst);
+
+            wake_if_waiting(m_control->m_consumer_waiting, m_control->m_data_seq);
+
+            return true;
+        }
+
+        /// Copies the next message into msg. Returns false if the ring is empty.
+        bool try_receive(std::vector<char>& msg)
+        {
+            counter_type       tail = m_control->m_tail.load(boost::memory_order_relaxed);
+            const counter_type head = m_control->m_head.load(boost::memory_order_seq_cst);
+
+            if(tail == head) return false;
+
+            std::size_t pos = std::size_t(tail & (m_capacity - 1));
+            word_type   len = load_word(m_data + pos);
+            if(len == word_type(wrap_marker))
+            {
+                tail += m_capacity - pos;
+                pos   = 0;
+                len   = load_word(m_data);
+            }
+            msg.assign(m_data + pos + header_size, m_data + pos + header_size + len);
+
+            m_control->m_tail.store(tail + aligned(header_size + len), boost::memory_order_seq_cst);
+
+            wake_if_waiting(m_control->m_producer_waiting, m_control->m_space_seq);
+
+            return true;
+        }
+
+        /// Blocks until the message fits or timeout_ms elapses (-1 waits forever). Returns
+        /// false on timeout, if the ring was closed or once the consumer stopped receiving.
+        bool send(const void* msg, std::size_t len, int timeout_ms = -1)
+        {
+            if(m_control->m_stopped.load()) return false;
+
+            while(!try_send(msg, len))
+            {
+                if(m_control->m_closed.load() || m_control->m_stopped.load()) return false;
+
+                if(!sleep_unless(m_control->m_producer_waiting, m_control->m_space_seq, timeout_ms, ring_full(*this, len))) return false;
+            }
+            return true;
+        }
+
+        /// Blocks until a message arrives or timeout_ms elapses (-1 waits forever). Returns
+        /// false on timeout or if the ring is empty and closed.
+        bool receive(std::vector<char>& msg, int timeout_ms = -1)
+        {
+            while(!try_receive(msg))
+            {
+                if(m_control->m_closed.load() && empty()) return false;
+
+                if(!sleep_unless(m_control->m_consumer_waiting, m_control->m_data_seq, timeout_ms, ring_empty(*this))) return false;
+            }
+            return true;
+        }
+
+        /// Whether a message of len bytes fits right now.
+        bool fits(std::size_t len) const
+        {
+            const counter_type head = m_control->m_head.load(boost::memory_order_seq_cst);
+            const counter_type tail = m_control->m_tail.load(boost::memory_order_seq_cst);
+
+            return m_capacity - std::size_t(head - tail) >= required_space(head, len);
+        }
+
+        bool empty() const
+        {
+            return m_control->m_head.load(boost::memory_order_seq_cst) == m_control->m_tail.load(boost::memory_order_seq_cst);
+        }
+
+        /// Tells the consumer no more messages will follow.
+        void close()
+        {
+            m_control->m_closed.store(1);
+            m_control->m_consumer_waiting.store(1); // force the wake up
+            wake_if_waiting(m_control->m_consumer_waiting, m_control->m_data_seq);
+        }
+
+        /// Tells the producer no more messages will be received, failing its sends.
+        void stop_receiving()
+        {
+            m_control->m_stopped.store(1);
+            m_control->m_producer_waiting.store(1); // force the wake up
+            wake_if_waiting(m_control->m_producer_waiting, m_control->m_space_seq);
+        }
+
+        control*    m_control;
+        char*       m_data;
+        std::size_t m_capacity;
+
+    private:
+        struct ring_empty
+        {
+            const shm_ring& m_r;
+            ring_empty(const shm_ring& r) : m_r(r) {}
+            bool operator()() const { return m_r.empty() && !m_r.m_control->m_closed.load(); }
+        };
+
+        struct ring_full
+        {
+            const shm_ring& m_r;
+            std::size_t     m_len;
+            ring_full(const shm_ring& r, std::size_t len) : m_r(r), m_len(len) {}
+            bool operator()() const { return !m_r.fits(m_len) && !m_r.m_control->m_closed.load() && !m_r.m_control->m_stopped.load(); }
+        };
+
+        static std::size_t aligned(std::size_t n) { return (n + 7) & ~std::size_t(7); }
+
+        /// A record that does not fit before the end of the buffer also uses up the rest of it.
+        std::size_t required_space(counter_type head, std::size_t len) const
+        {
+            const std::size_t contiguous = m_capacity - std::size_t(head & (m_capacity - 1));
+            const std::size_t record     = aligned(header_size + len);
+
+            return (record > contiguous)? contiguous + record : record;
+        }
+
+        static void      store_word(char* p, word_type w) { std::memcpy(p, &w, sizeof(w)); }
+        static word_type  load_word(const char* p)        { word_type w; std::memcpy(&w, p, sizeof(w)); return w; }
+
+        static int* futex_word(boost::atomic<word_type>& w) { return reinterpret_cast<int*>(&w); }
+
+        /// Announces the sleep in waiting, rechecks condition and sleeps on seq. Returns
+        /// false if timeout_ms elapsed.
+        template<class Condition>
+        static bool sleep_unless(boost::atomic<word_type>& waiting, boost::atomic<word_type>& seq, int timeout_ms, Condition still_blocked)
+        {
+            const word_type expected = seq.load();
+
+            waiting.store(1, boost::memory_order_seq_cst);
+
+            bool timed_out = false;
+            if(still_blocked())
+            {
+                struct timespec ts = { timeout_ms / 1000, (timeout_ms % 1000) * 1000000L };
+
+                timed_out = (::syscall(SYS_futex, futex_word(seq), FUTEX_WAIT, expected, (timeout_ms < 0)? 0 : &ts, 0, 0) == -1 && errno == ETIMEDOUT);
+            }
+            waiting.store(0, boost::memory_order_relaxed);
+
+            return !timed_out;
+        }
+
+        static void wake_if_waiting(boost::atomic<word_type>& waiting, boost::atomic<word_type>& seq)
+        {
+            if(waiting.load(boost::memory_order_seq_cst) && waiting.exchange(0))
+            {
+                seq.fetch_add(1);
+                ::syscall(SYS_futex, futex_word(seq), FUTEX_WAKE, 1, 0, 0, 0);
+            }
+        }
+    };
+
+    /// A pair of shm_rings between the parent and a child, one in each direction, in one
+    /// memfd. Used as an initializer it keeps the memfd open in the child, which attaches
+    /// to it with shm_ray(shm_ray::attach_to(fd)). The fd number is the same in the child,
+    /// it can be handed over on the command line or with the env from environment_variable(),
+    /// which the child finds with attach_to::from_environment().
+    ///
+    /// Each side only sends on m_sink and receives on m_source, and a ring must not have
+    /// more than one sending or receiving thread. Destroying either side closes its sink
+    /// and stops receiving on its source, which wakes the peer's blocked send or receive.
+    /// A side that dies without its destructor running tells its peer nothing: where that
+    /// can happen, the peer sends and receives with a timeout and checks in between whether
+    /// the other process still runs, the parent e.g. with the child's pidfd::open(pid).
+    class shm_ray : public initializer, private boost::noncopyable
+    {
+    public:
+        // multiple shm_rays can be passed to the same child.
+        typedef initializer_combination::ignore combination_category;
+        typedef child_memory::shared child_memory_category;
+
+        enum { default_capacity = 1 << 20 };
+
+        static const char* environment_name() { return "BOOST_PROCESS_SHM_RAY"; }
+
+        struct attach_to
+        {
+            explicit attach_to(int fd) : m_fd(fd) {}
+
+            static attach_to from_environment()
+            {
+                const char* v = getenv(environment_name());
+
+                return attach_to(v? std::atoi(v) : -1);
+            }
+
+            int m_fd;
+        };
+
+        /// Parent side. capacity is rounded up to a power of two.
+        explicit shm_ray(std::size_t capacity = default_capacity)
+        : m_fd(-1), m_mem(0), m_capacity(round_up(capacity))
+        {
+            m_fd = ::memfd_create("boost_process_shm_ray", MFD_CLOEXEC);
+            if(m_fd == -1 || ftruncate(m_fd, 2 * shm_ring::mapping_size(m_capacity)) == -1)
+            {
+                detail::throw_last_error();
+            }
+            map(m_capacity);
+
+            std::memset(m_mem, 0, 2 * sizeof(shm_ring::control));
+
+            m_sink  .attach(ring(0), m_capacity);
+            m_source.attach(ring(1), m_capacity);
+        }
+
+        /// Child side, attaches to the memfd created by the parent.
+        explicit shm_ray(const attach_to& a)
+        : m_fd(a.m_fd), m_mem(0), m_capacity(0)
+        {
+            struct stat st;
+            if(m_fd == -1 || fstat(m_fd, &st) == -1)
+            {
+                detail::throw_last_error();
+            }
+            map(std::size_t(st.st_size) / 2 - sizeof(shm_ring::control));
+
+            m_sink  .attach(ring(1), m_capacity);
+            m_source.attach(ring(0), m_capacity);
+        }
+
+        ~shm_ray()
+        {
+            if(m_mem)
+            {
+                m_sink.close();
+                m_source.stop_receiving();
+                munmap(m_mem, 2 * shm_ring::mapping_size(m_capacity));
+            }
+            if(m_fd != -1) close(m_fd);
+        }
+
+        int handle() const { return m_fd; }
+
+        env environment_variable() const { return env(environment_name(), m_fd); }
+
+        template<class Executor> void pre_fork_parent(Executor& e) const
+        {
+            e.set_in_use(m_fd);
+        }
+        template<class Executor> void post_fork_child(Executor& e) const
+        {
+            if(fcntl(m_fd, F_SETFD, 0) == -1) e.child_throw(errno, "fcntl", "shm_ray");
+        }
+
+        shm_ring   m_sink;
+        shm_ring m_source;
+
+    private:
+        static std::size_t round_up(std::size_t n)
+        {
+            std::size_t p = 4096;
+            while(p < n) p <<= 1;
+            return p;
+        }
+
+        void map(std::size_t capacity)
+        {
+            m_capacity = capacity;
+
+            void* mem = mmap(0, 2 * shm_ring::mapping_size(m_capacity), PROT_READ|PROT_WRITE, MAP_SHARED, m_fd, 0);
+            if(mem == MAP_FAILED)
+            {
+                detail::throw_last_error();
+            }
+            m_mem = static_cast<char*>(mem);
+        }
+
+        void* ring(int i) const { return m_mem + i * shm_ring::mapping_size(m_capacity); }
+
+        int         m_fd;
+        char*       m_mem;
+        std::size_t m_capacity;
+    };
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_SHM_RAY_HPP
@@ -0,0 +1,262 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_SPAWNER_HPP
+#define BOOST_PROCESS_POSIX_SPAWNER_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/make_child.hpp>
+#include <boost/process/posix/child.hpp>
+#include <boost/process/posix/detail/helpers.hpp>
+#include <boost/atomic.hpp>
+#include <boost/function.hpp>
+#include <boost/fusion/container/generation/make_vector.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <cerrno>
+#include <exception>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+
+namespace boost { namespace process { namespace posix {
+
+    /// A thread of its own that launches children for other threads, so that threads with
+    /// latency budgets, e.g. request handlers, never fork themselves.
+    ///
+    /// submit() copies the initializers and pushes the launch onto a lock-free queue, which
+    /// costs an allocation and a compare-and-swap, plus a write to a pipe if the thread is
+    /// idle. The thread runs the launches in submission order through make_child, with its
+    /// backend and fork_regions, and then calls the launch's callback with the child, or
+    /// with the exception make_child threw and no child.
+    ///
+    /// Callbacks run on the spawner's thread and delay the launches behind them, so they
+    /// should only hand the child on, e.g. to a queue or a collector. They must not throw,
+    /// an exception escaping one is dropped. Initializers holding references, e.g. to a
+    /// file_descriptor_ray, need their referents until the callback ran. The thread has the
+    /// signal mask of the thread that created the spawner, which its children inherit.
+    ///
+    /// The destructor runs the launches submitted so far and then joins the thread.
+    ///
+    /// \code
+    ///     bp::posix::spawner s;
+    ///     s.submit(boost::bind(&on_launched, request_id, _1, _2), bp::paths(exe), bp::args("--serve"));
+    ///     ...
+    ///     void on_launched(int request_id, const bp::child& c, const std::exception* error);
+    /// \endcode
+    class spawner : private boost::noncopyable
+    {
+    public:
+        /// Called with the child and 0, or with child() and what make_child threw.
+        typedef boost::function<void (const child&, const std::exception*)> callback_type;
+
+        /// A launch, any nullary callable returning the child.
+        typedef boost::function<child ()> launch_type;
+
+        spawner() : m_head(0), m_pending(0), m_stop(false), m_wake_read(-1), m_wake_write(-1), m_thread()
+        {
+            int fds[2];
+#if defined(__linux__)
+            if(::pipe2(fds, O_CLOEXEC|O_NONBLOCK) == -1) detail::throw_last_error();
+#else
+            if(::pipe(fds) == -1) detail::throw_last_error();
+            for(int i = 0; i < 2; ++i)
+            {
+                fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+                fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+            }
+#endif
+            m_wake_read  = fds[0];
+            m_wake_write = fds[1];
+
+            int error = pthread_create(&m_thread, 0, &run, this);
+            if(error)
+            {
+                close(m_wake_read); close(m_wake_write);
+                throw boost::system::system_error(boost::system::error_code(error, boost::system::system_category()));
+            }
+        }
+
+        ~spawner()
+        {
+            m_stop.store(true, boost::memory_order_release);
+            wake();
+            pthread_join(m_thread, 0);
+
+            close(m_wake_read);
+            close(m_wake_write);
+        }
+
+        /// Queues a launch by any callable, e.g. one binding make_child to initializers kept elsewhere.
+        void submit_launch(const launch_type& launch, const callback_type& done)
+        {
+            node* n = new node(launch, done);
+            m_pending.fetch_add(1, boost::memory_order_relaxed);
+
+            n->m_next = m_head.load(boost::memory_order_relaxed);
+            while(!m_head.compare_exchange_weak(n->m_next, n, boost::memory_order_release, boost::memory_order_relaxed)) {}
+
+            // only the first launch of a batch wakes the thread, it takes the whole queue
+            if(!n->m_next) wake();
+        }
+
+        /// Queues make_child(a1, ...) on copies of the initializers.
+        template<typename A1>
+        void submit(const callback_type& done, const A1& a1)
+        {
+            submit_sequence(done, boost::fusion::make_vector(a1));
+        }
+
+        template<typename A1, typename A2>
+        void submit(const callback_type& done, const A1& a1, const A2& a2)
+        {
+            submit_sequence(done, boost::fusion::make_vector(a1, a2));
+        }
+
+        template<typename A1, typename A2, typename A3>
+        void submit(const callback_type& done, const A1& a1, const A2& a2, const A3& a3)
+        {
+            submit_sequence(done, boost::fusion::make_vector(a1, a2, a3));
+        }
+
+        template<typename A1, typename A2, typename A3, typename A4>
+        void submit(const callback_type& done, const A1& a1, const A2& a2, const A3& a3, const A4& a4)
+        {
+            submit_sequence(done, boost::fusion::make_vector(a1, a2, a3, a4));
+        }
+
+        template<typename A1, typename A2, typename A3, typename A4, typename A5>
+        void submit(const callback_type& done, const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5)
+        {
+            submit_sequence(done, boost::fusion::make_vector(a1, a2, a3, a4, a5));
+        }
+
+        template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6>
+        void submit(const callback_type& done, const A1& a1, const A2& a2, const A3& a3, const A4& a4, const A5& a5, const A6& a6)
+        {
+            submit_sequence(done, boost::fusion::make_vector(a1, a2, a3, a4, a5, a6));
+        }
+
+        /// Number of launches submitted whose callback has not returned yet.
+        std::size_t pending() const { return m_pending.load(boost::memory_order_acquire); }
+
+    private:
+        struct node
+        {
+            node(const launch_type& launch, const callback_type& done) : m_launch(launch), m_done(done), m_next(0) {}
+
+            launch_type   m_launch;
+            callback_type m_done;
+            node*         m_next;
+        };
+
+        /// The initializers, copied, launched on the spawner's thread.
+        template<typename Sequence> struct sequence_launch
+        {
+            explicit sequence_launch(const Sequence& s) : m_initializers(s) {}
+
+            child operator()() const { return boost::process::detail::execute(m_initializers); }
+
+            Sequence m_initializers;
+        };
+
+        template<typename Sequence> void submit_sequence(const callback_type& done, const Sequence& s)
+        {
+            submit_launch(sequence_launch<Sequence>(s), done);
+        }
+
+        void wake()
+        {
+            char c = 0;
+            ssize_t n = ::write(m_wake_write, &c, 1); // full pipe: a wake-up is pending anyway
+            (void)n;
+        }
+
+        static void* run(void* self)
+        {
+            static_cast<spawner*>(self)->loop();
+            return 0;
+        }
+
+        void loop()
+        {
+            for(;;)
+            {
+                node* batch = m_head.exchange(0, boost::memory_order_acquire);
+                if(!batch)
+                {
+                    if(m_stop.load(boost::memory_order_acquire)) return;
+
+                    pollfd p = { m_wake_read, POLLIN, 0 };
+                    ::poll(&p, 1, -1);
+
+                    char buffer[64];
+                    while(::read(m_wake_read, buffer, sizeof(buffer)) > 0) {}
+                    continue;
+                }
+
+                // pushed newest first
+                node* first = 0;
+                while(batch)
+                {
+                    node* next = batch->m_next;
+                    batch->m_next = first;
+                    first = batch;
+                    batch = next;
+                }
+
+                while(first)
+                {
+                    node* next = first->m_next;
+                    launch(*first);
+                    delete first;
+                    m_pending.fetch_sub(1, boost::memory_order_release);
+                    first = next;
+                }
+            }
+        }
+
+        static void launch(const node& n)
+        {
+            try
+            {
+                child c = n.m_launch();
+                notify(n, c, 0);
+            }
+            catch(const std::exception& ex)
+            {
+                notify(n, child(), &ex);
+            }
+            catch(...)
+            {
+                const std::runtime_error unknown("spawner: unknown exception");
+                notify(n, child(), &unknown);
+            }
+        }
+
+        static void notify(const node& n, const child& c, const std::exception* error)
+        {
+            try
+            {
+                if(n.m_done) n.m_done(c, error);
+            }
+            catch(...) {}
+        }
+
+        boost::atomic<node*>       m_head;       // the queue, newest first
+        boost::atomic<std::size_t> m_pending;
+        boost::atomic<bool>        m_stop;
+        int                        m_wake_read;  // written to when the queue was empty
+        int                        m_wake_write;
+        pthread_t                  m_thread;
+    };
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_SPAWNER_HPP
@@ -0,0 +1,87 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_TERMINATION_POLICY_HPP
+#define BOOST_PROCESS_POSIX_TERMINATION_POLICY_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/pidfd.hpp>
+
+#include <vector>
+
+#include <signal.h>
+
+namespace boost { namespace process { namespace posix {
+
+    /// How to end a child: a sequence of signals, each followed by a grace period in which
+    /// the child may exit before the next one is sent. A grace period of -1 waits without
+    /// limit. The default sends SIGTERM, waits 5 seconds, then sends SIGKILL.
+    ///
+    /// With to_process_group the signals go to the child's whole process group, which needs
+    /// the child launched with new_process_group. Once the child is reaped, the last signal
+    /// goes to its group once more, so no descendant that ignored the others is left behind.
+    ///
+    /// \code
+    ///     bp::posix::termination_policy p = bp::posix::termination_policy(SIGINT, 1000)(SIGTERM, 2000)(SIGKILL);
+    ///     monitor.terminate(p.to_process_group());
+    /// \endcode
+    struct termination_policy
+    {
+        struct step
+        {
+            int m_signal;
+            int m_grace_ms;
+        };
+
+        typedef std::vector<step> steps_type;
+
+        termination_policy() : m_steps(), m_process_group(false)
+        {
+            (*this)(SIGTERM, 5000)(SIGKILL);
+        }
+
+        termination_policy(int sig, int grace_ms = -1) : m_steps(), m_process_group(false)
+        {
+            (*this)(sig, grace_ms);
+        }
+
+        termination_policy& operator()(int sig, int grace_ms = -1)
+        {
+            step s = { sig, grace_ms };
+            m_steps.push_back(s);
+
+            return *this;
+        }
+
+        termination_policy& to_process_group(bool b = true)
+        {
+            m_process_group = b;
+
+            return *this;
+        }
+
+        /// Sends sig to the process group of pid, or to pid itself, through its pidfd if
+        /// there is one. Returns -1 with errno set on failure.
+        int send(pid_t pid, int fd, int sig) const
+        {
+            if(m_process_group) return ::kill(-pid, sig);
+            if(fd != -1)        return pidfd::send_signal(fd, sig);
+
+            return ::kill(pid, sig);
+        }
+
+        /// Sends the last signal to the process group of pid if that still has members.
+        void sweep_process_group(pid_t pid) const
+        {
+            if(m_process_group && !m_steps.empty()) ::kill(-pid, m_steps.back().m_signal);
+        }
+
+        steps_type m_steps;
+        bool       m_process_group;
+    };
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_TERMINATION_POLICY_HPP
@@ -0,0 +1,387 @@
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_PROCESS_POSIX_WORKER_TEMPLATE_HPP
+#define BOOST_PROCESS_POSIX_WORKER_TEMPLATE_HPP
+
+#include <boost/process/config.hpp>
+#include <boost/process/posix/child.hpp>
+#include <boost/process/posix/detail/helpers.hpp>
+#include <boost/process/posix/initializers/initializer.hpp>
+#include <boost/process/posix/pidfd.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if !defined(__linux__)
+#   error "worker_template requires Linux (clone3, SCM_RIGHTS)"
+#endif
+
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace boost { namespace process { namespace posix {
+
+    /// One of the ready copies a worker_template forked. It is a child of this process like
+    /// any launched with make_child, so monitors join it. The streams are the parent's ends
+    /// of pipes to the copy's std streams; closed where the copy inherited the template's.
+    struct worker_copy
+    {
+        explicit worker_copy(pid_t pid) : m_child(pid) {}
+
+        child                                    m_child;
+        boost::iostreams::file_descriptor        m_pidfd;
+        boost::iostreams::file_descriptor_sink   m_std_in;
+        boost::iostreams::file_descriptor_source m_std_out;
+        boost::iostreams::file_descriptor_source m_std_err;
+    };
+
+    /// A worker launched once, which pays for its start up, e.g. loading models, and then
+    /// forks ready copies of itself on request. The copies begin where the template asked
+    /// for work, with everything it loaded shared copy-on-write, within microseconds.
+    ///
+    /// The parent launches the worker with control(), which hands it one end of a socket.
+    /// The worker initializes and calls serve(), which returns true in each copy and false
+    /// in the template once the parent destroyed the worker_template. fork_copies asks the
+    /// template for copies and waits until it reaches serve().
+    ///
+    /// The template forks with clone3 and CLONE_PARENT (Linux 5.3), so the copies are children
+    /// of the parent, not of the template, and come with a pidfd. pids, pidfds and the pipe
+    /// ends travel over the socket with SCM_RIGHTS. The copies start as a fork of a single
+    /// threaded process, so serve() has to be called while the template runs no other threads.
+    ///
+    /// \code
+    ///     // parent
+    ///     bp::posix::worker_template t;
+    ///     bp::monitor tm(bp::make_child(bp::paths(worker), t.control()));
+    ///     std::vector<bp::posix::worker_copy> copies = t.fork_copies(8);
+    ///
+    ///     // worker
+    ///     load_models();
+    ///     if(bp::posix::worker_template::launched_as_template() && !bp::posix::worker_template::serve()) return 0;
+    ///     serve_requests_on_std_streams();
+    /// \endcode
+    class worker_template : private boost::noncopyable
+    {
+    public:
+        /// Which std streams of the copies are piped to the parent.
+        enum streams_type { pipe_none = 0, pipe_std_in = 1, pipe_std_out = 2, pipe_std_err = 4, pipe_all = 7 };
+
+        static const char* environment_name() { return "BOOST_PROCESS_WORKER_TEMPLATE_FD"; }
+
+        worker_template() : m_control(-1), m_child_end(-1), m_env()
+        {
+            int fds[2];
+            if(::socketpair(AF_UNIX, SOCK_SEQPACKET|SOCK_CLOEXEC, 0, fds) == -1) detail::throw_last_error();
+
+            m_control   = fds[0];
+            m_child_end = fds[1];
+
+            const std::string env = std::string(environment_name()) + "=" + boost::lexical_cast<std::string>(m_child_end);
+            m_env.assign(env.begin(), env.end());
+            m_env.push_back(0);
+        }
+
+        /// Closing the socket ends the template's serve().
+        ~worker_template()
+        {
+            if(m_child_end != -1) close(m_child_end);
+            close(m_control);
+        }
+
+        /// Initializer for the template's launch: hands it the socket, under the same fd
+        /// number, named in the environment.
+        struct control_initializer : public initializer
+        {
+            typedef initializer_combination::exclusive combination_category;
+            typedef child_memory::shared child_memory_category;
+
+            explicit control_initializer(worker_template& t) : m_t(t) {}
+
+            template<class Executor> void pre_fork_parent(Executor& e) const
+            {
+                if(m_t.m_child_end == -1) throw std::logic_error("worker_template: launched twice");
+
+                e.inherit_fd(m_t.m_child_end, m_t.m_child_end);
+                e.add_child_env(&m_t.m_env[0]);
+            }
+
+            /// Only the template holds its end now, so the parent sees EOF once it is gone.
+            template<class Executor> void post_fork_parent(Executor&) const
+            {
+                close(m_t.m_child_end);
+                m_t.m_child_end = -1;
+            }
+
+            worker_template& m_t;
+        };
+
+        control_initializer control() { return control_initializer(*this); }
+
+        /// Asks the template for n copies and returns them once all were forked. If the
+        /// template fails to fork one, the others are killed and reaped and a system_error
+        /// is thrown; EPIPE if the template is gone. One call at a time.
+        std::vector<worker_copy> fork_copies(std::size_t n, unsigned streams = pipe_all)
+        {
+            request r = { boost::uint32_t(n), boost::uint32_t(streams) };
+            while(::send(m_control, &r, sizeof(r), MSG_NOSIGNAL) == -1)
+            {
+                if(errno != EINTR) detail::throw_last_error();
+            }
+
+            std::vector<worker_copy> copies;
+            copies.reserve(n);
+
+            int error = 0;
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                reply a;
+                int   fds[max_fds];
+                int   received = receive(a, fds);
+                if(received < 0) { error = -received; break; }
+
+                if(a.m_error)
+                {
+                    for(int k = 0; k < received; ++k) close(fds[k]);
+                    if(!error) error = a.m_error;
+                    continue;
+                }
+
+                worker_copy c(a.m_pid);
+
+                int k = 0;
+                c.m_pidfd.open(fds[k++], boost::iostreams::close_handle);
+                if(streams & pipe_std_in)  c.m_std_in .open(fds[k++], boost::iostreams::close_handle);
+                if(streams & pipe_std_out) c.m_std_out.open(fds[k++], boost::iostreams::close_handle);
+                if(streams & pipe_std_err) c.m_std_err.open(fds[k++], boost::iostreams::close_handle);
+
+                copies.push_back(c);
+            }
+
+            if(error)
+            {
+                for(std::size_t i = 0; i < copies.size(); ++i)
+                {
+                    pidfd::send_signal(copies[i].m_pidfd.handle(), SIGKILL);
+                    while(::waitpid(copies[i].m_child.handle(), 0, 0) == -1 && errno == EINTR) {}
+                }
+                throw boost::system::system_error(boost::system::error_code(error, boost::system::system_category()));
+            }
+            return copies;
+        }
+
+        /// True in a process launched with control().
+        static bool launched_as_template() { return control_fd() != -1; }
+
+        /// Called by the template once initialized: forks copies as the parent asks for them.
+        /// Returns true in each copy, with the std streams connected as requested, and false
+        /// in the template once the parent closed its end, or if there is no control socket.
+        static bool serve()
+        {
+            const int fd = control_fd();
+            if(fd == -1) return false;
+
+            for(;;)
+            {
+                request r;
+                ssize_t n = ::recv(fd, &r, sizeof(r), 0);
+                if(n == -1 && errno == EINTR) continue;
+                if(n != ssize_t(sizeof(r)))
+                {
+                    close(fd);
+                    return false;
+                }
+
+                for(boost::uint32_t i = 0; i < r.m_count; ++i)
+                {
+                    if(fork_one(fd, r.m_streams)) return true;
+                }
+            }
+        }
+
+    private:
+        enum { max_fds = 4 };
+
+        enum { clone_pidfd = 0x00001000 }; // CLONE_PIDFD, missing from older headers
+
+        struct request
+        {
+            boost::uint32_t m_count;
+            boost::uint32_t m_streams;
+        };
+
+        struct reply
+        {
+            pid_t m_pid;
+            int   m_error;
+        };
+
+        /// The arguments of clone3 as of Linux 5.3.
+        struct clone_args_v0
+        {
+            boost::uint64_t m_flags;
+            boost::uint64_t m_pidfd;
+            boost::uint64_t m_child_tid;
+            boost::uint64_t m_parent_tid;
+            boost::uint64_t m_exit_signal;
+            boost::uint64_t m_stack;
+            boost::uint64_t m_stack_size;
+            boost::uint64_t m_tls;
+        };
+
+        static int control_fd()
+        {
+            const char* v = std::getenv(environment_name());
+            if(!v || !*v) return -1;
+
+            char* end = 0;
+            long fd = std::strtol(v, &end, 10);
+            return (*end || fd < 0)? -1 : int(fd);
+        }
+
+        /// Forks one copy and reports it to the parent. Returns true in the copy.
+        static bool fork_one(int control, boost::uint32_t streams)
+        {
+            int pipes[3][2] = { {-1, -1}, {-1, -1}, {-1, -1} };
+            int error = 0;
+
+            for(int s = 0; s < 3 && !error; ++s)
+            {
+                if((streams & (1u << s)) && ::pipe2(pipes[s], O_CLOEXEC) == -1) error = errno;
+            }
+
+            // or the copy writes out what the template buffered, too
+            std::fflush(0);
+
+            int   pidfd = -1;
+            pid_t pid   = -1;
+            if(!error)
+            {
+#if defined(SYS_clone3)
+                clone_args_v0 a;
+                std::memset(&a, 0, sizeof(a));
+                a.m_flags = CLONE_PARENT | clone_pidfd; // the exit signal is the template's own, SIGCHLD
+                a.m_pidfd = boost::uint64_t(reinterpret_cast<std::size_t>(&pidfd)); // through a pointer sized integer, 32 bit too
+
+                pid = pid_t(::syscall(SYS_clone3, &a, sizeof(a)));
+                if(pid == -1) error = errno;
+#else
+                error = ENOSYS;
+#endif
+            }
+
+            if(pid == 0)
+            {
+                // the child's end of each pipe becomes its std stream
+                for(int s = 0; s < 3; ++s)
+                {
+                    if(pipes[s][0] == -1) continue;
+                    ::dup2(pipes[s][(s == 0)? 0 : 1], s);
+                    close(pipes[s][0]); close(pipes[s][1]);
+                }
+                close(control);
+                ::unsetenv(environment_name());
+                return true;
+            }
+
+            reply a = { pid, error };
+
+            // the parent's ends: stdin's write end, stdout's and stderr's read ends
+            int fds[max_fds];
+            int n = 0;
+            if(!error)
+            {
+                fds[n++] = pidfd;
+                for(int s = 0; s < 3; ++s) if(pipes[s][0] != -1) fds[n++] = pipes[s][(s == 0)? 1 : 0];
+            }
+            send_reply(control, a, fds, n);
+
+            if(pidfd != -1) close(pidfd);
+            for(int s = 0; s < 3; ++s)
+            {
+                if(pipes[s][0] != -1) { close(pipes[s][0]); close(pipes[s][1]); }
+            }
+            return false;
+        }
+
+        static void send_reply(int control, const reply& a, const int* fds, int n)
+        {
+            iovec iov = { const_cast<reply*>(&a), sizeof(a) };
+
+            char control_buffer[CMSG_SPACE(max_fds * sizeof(int))];
+            std::memset(control_buffer, 0, sizeof(control_buffer));
+
+            msghdr m;
+            std::memset(&m, 0, sizeof(m));
+            m.msg_iov    = &iov;
+            m.msg_iovlen = 1;
+            if(n)
+            {
+                m.msg_control    = control_buffer;
+                m.msg_controllen = CMSG_SPACE(n * sizeof(int));
+
+                cmsghdr* c    = CMSG_FIRSTHDR(&m);
+                c->cmsg_level = SOL_SOCKET;
+                c->cmsg_type  = SCM_RIGHTS;
+                c->cmsg_len   = CMSG_LEN(n * sizeof(int));
+                std::memcpy(CMSG_DATA(c), fds, n * sizeof(int));
+            }
+
+            while(::sendmsg(control, &m, MSG_NOSIGNAL) == -1 && errno == EINTR) {}
+        }
+
+        /// Returns the number of fds received, or minus an errno value.
+        int receive(reply& a, int* fds)
+        {
+            iovec iov = { &a, sizeof(a) };
+
+            char control_buffer[CMSG_SPACE(max_fds * sizeof(int))];
+
+            msghdr m;
+            std::memset(&m, 0, sizeof(m));
+            m.msg_iov        = &iov;
+            m.msg_iovlen     = 1;
+            m.msg_control    = control_buffer;
+            m.msg_controllen = sizeof(control_buffer);
+
+            ssize_t n;
+            while((n = ::recvmsg(m_control, &m, MSG_CMSG_CLOEXEC)) == -1 && errno == EINTR) {}
+            if(n == -1)                  return -errno;
+            if(n != ssize_t(sizeof(a)))  return -EPIPE;
+
+            int received = 0;
+            for(cmsghdr* c = CMSG_FIRSTHDR(&m); c; c = CMSG_NXTHDR(&m, c))
+            {
+                if(c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_RIGHTS) continue;
+
+                received = int((c->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+                std::memcpy(fds, CMSG_DATA(c), received * sizeof(int));
+            }
+            return received;
+        }
+
+        int               m_control;   // the parent's end
+        int               m_child_end; // the template's end until it is launched
+        std::vector<char> m_env;       // "BOOST_PROCESS_WORKER_TEMPLATE_FD=<fd>"
+    };
+
+}}}
+
+#endif // BOOST_PROCESS_POSIX_WORKER_TEMPLATE_HPP
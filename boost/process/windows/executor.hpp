@@ -96,6 +96,21 @@ namespace boost { namespace process { namespace windows {
             return child(m_process_info.hProcess);
         }
 
+        /// As exec, reporting a system_error of the launch in ec instead of throwing it.
+        template<typename INITIALIZERS> child exec(const INITIALIZERS& izs, boost::system::error_code& ec)
+        {
+            ec.clear();
+            try
+            {
+                return exec(izs);
+            }
+            catch(const boost::system::system_error& x)
+            {
+                ec = x.code();
+                return child();
+            }
+        }
+
         BOOST_PROCESS_EXECUTOR_METHOD(   pre_create)
         BOOST_PROCESS_EXECUTOR_METHOD(  post_create)
         BOOST_PROCESS_EXECUTOR_METHOD(failed_create)
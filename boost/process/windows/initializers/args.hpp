@@ -72,6 +72,9 @@ namespace boost { namespace process { namespace windows {
 
 	struct args : public initializer 
     {
+        // multiple args initializers can be combined in one sequence.
+        typedef initializer_combination::ignore combination_category;
+
         typedef std::vector<arg> args_type;
 
         args() : m_args() {}
@@ -16,6 +16,7 @@
 
 #include <boost/process/config.hpp>
 #include <boost/process/windows/initializers/initializer.hpp>
+#include <boost/process/detail/flat_map.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/shared_array.hpp>
 
@@ -129,10 +130,10 @@ namespace boost { namespace process { namespace windows {
          * Neither POSIX nor Windows systems support a variable with no name.
          *
          * It is worthy to note that the environment is sorted alphabetically.
-         * This is provided for-free by the map container used to implement this
-         * type, and this behavior is required by Windows systems.
+         * This is provided for-free by the sorted flat container used to implement
+         * this type, and this behavior is required by Windows systems.
          */
-        typedef std::map<std::wstring, std::wstring, case_insensitve_sort> environment_type;
+        typedef detail::flat_map<std::wstring, std::wstring, case_insensitve_sort> environment_type;
         // multiple environment initializers should not be combined in one sequence.
         typedef initializer_combination::exclusive combination_category;
         typedef boost::filesystem::path path;
@@ -180,7 +181,7 @@ namespace boost { namespace process { namespace windows {
             if ((lb != m_environment.end()) && !(m_environment.key_comp()(e.m_namevalue.first, lb->first)))
             {
                 // setting a new value overwrites the existing one
-                m_environment[e.m_namevalue.first] = e.m_namevalue.second;
+                lb->second = e.m_namevalue.second;
             }
             else
             {
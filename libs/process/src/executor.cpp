@@ -0,0 +1,15 @@
+// Boost.Process library
+// The posix executor's core and the hooks of the common launches, compiled once for
+// programs built with BOOST_PROCESS_SEPARATE_COMPILATION.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#if !defined(BOOST_PROCESS_SEPARATE_COMPILATION)
+#   define BOOST_PROCESS_SEPARATE_COMPILATION
+#endif
+#define BOOST_PROCESS_INSTANTIATE_COMMON_LAUNCHES
+
+#include <boost/process/posix/impl/executor.ipp>
+#include <boost/process/posix/common_launches.hpp>
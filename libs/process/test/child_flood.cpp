@@ -0,0 +1,55 @@
+// Boost.Process library
+// Child program for the collector tests: writes the given number of bytes to
+// stdout and to stderr in alternating chunks, as lines of 'o' and 'e'.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+    const std::size_t chunk_size = 64 * 1024;
+    const std::size_t line_size  = 64;
+
+    bool write_all(int fd, const char* data, std::size_t len)
+    {
+        while(len)
+        {
+            ssize_t n = write(fd, data, len);
+            if(n <= 0) return false;
+            data += n; len -= std::size_t(n);
+        }
+        return true;
+    }
+
+    void fill_lines(std::vector<char>& chunk, char c)
+    {
+        std::memset(&chunk[0], c, chunk.size());
+        for(std::size_t i = line_size - 1; i < chunk.size(); i += line_size) chunk[i] = '\n';
+    }
+
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long long bytes = (argc > 1)? std::strtoull(argv[1], 0, 10) : 0;
+
+    std::vector<char> out(chunk_size), err(chunk_size);
+    fill_lines(out, 'o');
+    fill_lines(err, 'e');
+
+    while(bytes)
+    {
+        const std::size_t n = (bytes < chunk_size)? std::size_t(bytes) : chunk_size;
+        if(!write_all(STDOUT_FILENO, &out[0], n) || !write_all(STDERR_FILENO, &err[0], n)) return EXIT_FAILURE;
+        bytes -= n;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,39 @@
+// Boost.Process library
+// Child program for the shm_ray tests: "echo" sends every message back,
+// "count" replies with the number of messages once the parent closed its ring,
+// "quit" exits right away.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include <boost/process/posix/shm_ray.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace bp = boost::process::posix;
+
+int main(int argc, char *argv[])
+{
+    bp::shm_ray ray(bp::shm_ray::attach_to::from_environment());
+
+    if((argc > 1) && (std::strcmp(argv[1], "quit") == 0)) return EXIT_SUCCESS;
+
+    const bool echo = (argc > 1) && (std::strcmp(argv[1], "echo") == 0);
+
+    std::vector<char> msg;
+    unsigned long count = 0;
+
+    while(ray.m_source.receive(msg))
+    {
+        ++count;
+        if(echo) ray.m_sink.send(msg.empty()? 0 : &msg[0], msg.size());
+    }
+
+    if(!echo) ray.m_sink.send(&count, sizeof(count));
+    ray.m_sink.close();
+
+    return EXIT_SUCCESS;
+}
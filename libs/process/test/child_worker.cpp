@@ -0,0 +1,40 @@
+// Boost.Process library
+// Child program for the worker_template tests: "loads" for the given number of
+// milliseconds and megabytes, then serves as a template if launched as one. Each
+// worker says "ready <parent pid> <model byte>" and echoes its stdin.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include <boost/process/posix/worker_template.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <unistd.h>
+
+namespace bp = boost::process;
+
+int main(int argc, char *argv[])
+{
+    const int         init_ms  = (argc > 1)? std::atoi(argv[1]) : 0;
+    const std::size_t model_mb = (argc > 2)? std::size_t(std::atoi(argv[2])) : 0;
+
+    std::vector<char> model((model_mb << 20) + 1, 'm');
+    usleep(useconds_t(init_ms) * 1000);
+
+    if(bp::posix::worker_template::launched_as_template() && !bp::posix::worker_template::serve()) return 0;
+
+    std::printf("ready %d %c\n", int(getppid()), model[0]);
+    std::fflush(stdout);
+
+    char buffer[4096];
+    ssize_t n;
+    while((n = read(STDIN_FILENO, buffer, sizeof(buffer))) > 0)
+    {
+        if(write(STDOUT_FILENO, buffer, std::size_t(n)) != n) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,181 @@
+// Boost.Process library
+// Stress benchmark for draining stdout and stderr of children: the collector's
+// epoll and io_uring backends on one thread against a reader thread per stream.
+// Every child writes the given number of bytes, 1 GB by default, to both of its
+// streams; with more children than fds allow, only stdout is collected.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/collector.hpp>
+#include <boost/chrono.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread.hpp>
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace bp = boost::process;
+namespace bc = boost::chrono;
+
+namespace {
+
+    const std::string child_flood("./child_flood");
+
+    struct byte_counter
+    {
+        unsigned long long m_bytes;
+        byte_counter() : m_bytes(0) {}
+        void operator()(const char*, std::size_t len) { m_bytes += len; }
+    };
+
+    struct blocking_reader
+    {
+        int m_fd;
+        unsigned long long* m_bytes;
+        blocking_reader(int fd, unsigned long long* bytes) : m_fd(fd), m_bytes(bytes) {}
+        void operator()() const
+        {
+            std::vector<char> chunk(bp::posix::collector::chunk_size);
+            ssize_t n;
+            while((n = read(m_fd, &chunk[0], chunk.size())) > 0) *m_bytes += n;
+        }
+    };
+
+    /// Streams per child that fit into the fd limit, raised as far as allowed.
+    int streams_for(int children)
+    {
+        rlimit l;
+        getrlimit(RLIMIT_NOFILE, &l);
+        l.rlim_cur = l.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &l);
+
+        return (rlim_t(2 * children + 64) <= l.rlim_cur)? 2 : 1;
+    }
+
+    void launch(int children, const std::string& bytes, std::vector<bp::file_descriptor_ray>& rays, std::vector<bp::monitor>& monitors)
+    {
+        const int streams = streams_for(children);
+
+        for(int i = 0; i < children; ++i)
+        {
+            for(int j = 0; j < streams; ++j) rays.push_back(bp::file_descriptor_ray());
+
+            if(streams == 2)
+            {
+                monitors.push_back(bp::monitor(bp::make_child(bp::paths(child_flood), bp::args(bytes),
+                                                              bp::std_out_to(rays[2 * i]), bp::std_err_to(rays[2 * i + 1]))));
+            }
+            else
+            {
+                monitors.push_back(bp::monitor(bp::make_child(bp::paths(child_flood), bp::args(bytes), bp::std_out_to(rays[i]))));
+            }
+            // keeps the parent's fds at one per stream
+            for(int j = streams * i; j < streams * (i + 1); ++j) rays[j].m_sink.close();
+        }
+    }
+
+    unsigned long long collected(int children, const std::string& bytes, bp::posix::collector::mode_type mode, bp::posix::collector::backend_type backend)
+    {
+        std::vector<bp::file_descriptor_ray> rays;
+        std::vector<bp::monitor> monitors;
+        launch(children, bytes, rays, monitors);
+
+        byte_counter counter;
+        bp::posix::collector c(backend);
+        for(std::size_t i = 0; i < rays.size(); ++i) c.add(rays[i], boost::ref(counter), mode);
+        c.run();
+
+        for(std::size_t i = 0; i < monitors.size(); ++i) monitors[i].join();
+        return counter.m_bytes;
+    }
+
+    unsigned long long threaded(int children, const std::string& bytes)
+    {
+        std::vector<bp::file_descriptor_ray> rays;
+        std::vector<bp::monitor> monitors;
+        launch(children, bytes, rays, monitors);
+
+        std::vector<unsigned long long> counts(rays.size());
+        boost::thread_group readers;
+        for(std::size_t i = 0; i < rays.size(); ++i)
+        {
+            rays[i].m_sink.close();
+            readers.create_thread(blocking_reader(rays[i].m_source.handle(), &counts[i]));
+        }
+        readers.join_all();
+
+        for(std::size_t i = 0; i < monitors.size(); ++i) monitors[i].join();
+
+        unsigned long long total = 0;
+        for(std::size_t i = 0; i < counts.size(); ++i) total += counts[i];
+        return total;
+    }
+
+    double cpu_seconds()
+    {
+        rusage u;
+        getrusage(RUSAGE_SELF, &u);
+
+        return u.ru_utime.tv_sec + u.ru_stime.tv_sec + (u.ru_utime.tv_usec + u.ru_stime.tv_usec) * 1e-6;
+    }
+
+    /// Launching is part of the time, the parent's CPU time is mostly collecting.
+    template<class F> void measure(const std::string& name, F f)
+    {
+        bc::steady_clock::time_point start = bc::steady_clock::now();
+        const double cpu = cpu_seconds();
+
+        unsigned long long bytes = f();
+
+        bc::duration<double> elapsed = bc::steady_clock::now() - start;
+
+        std::cout << std::left  << std::setw(44) << name
+                  << std::right << std::setw(10) << std::fixed << std::setprecision(1) << (bytes / elapsed.count() / (1 << 20)) << " MB/s  "
+                  << std::setw(8) << std::setprecision(0) << (bytes >> 20) << " MB  "
+                  << std::setw(8) << std::setprecision(0) << ((cpu_seconds() - cpu) * 1e3) << " ms parent CPU" << std::endl;
+    }
+
+    struct run_collected
+    {
+        int m_children; std::string m_bytes; bp::posix::collector::mode_type m_mode; bp::posix::collector::backend_type m_backend;
+        run_collected(int c, const std::string& b, bp::posix::collector::mode_type m, bp::posix::collector::backend_type e) : m_children(c), m_bytes(b), m_mode(m), m_backend(e) {}
+        unsigned long long operator()() const { return collected(m_children, m_bytes, m_mode, m_backend); }
+    };
+
+    struct run_threaded
+    {
+        int m_children; std::string m_bytes;
+        run_threaded(int c, const std::string& b) : m_children(c), m_bytes(b) {}
+        unsigned long long operator()() const { return threaded(m_children, m_bytes); }
+    };
+
+}
+
+int main(int argc, char *argv[])
+{
+    const std::string bytes = (argc > 1)? argv[1] : "1073741824";
+    const int children      = (argc > 2)? boost::lexical_cast<int>(argv[2]) : 1;
+
+    const std::string suffix = ", " + boost::lexical_cast<std::string>(children) + " child(ren)";
+
+    typedef bp::posix::collector c;
+
+    measure("epoll, chunks"    + suffix, run_collected(children, bytes, c::chunks, c::epoll_backend));
+    measure("io_uring, chunks" + suffix, run_collected(children, bytes, c::chunks, c::uring_backend));
+    measure("epoll, lines"     + suffix, run_collected(children, bytes, c::lines,  c::epoll_backend));
+    measure("io_uring, lines"  + suffix, run_collected(children, bytes, c::lines,  c::uring_backend));
+
+    // a thread per stream does not scale to thousands of children
+    if(children <= 100) measure("thread per stream" + suffix, run_threaded(children, bytes));
+
+    return 0;
+}
@@ -0,0 +1,301 @@
+// Boost.Process library
+// Tests draining the std streams of children with the collector.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE ProcessLib
+
+// Linux requires dynamic linkage of Boost.Test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/collector.hpp>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/filesystem.hpp>
+
+#include <list>
+#include <string>
+#include <vector>
+
+namespace bp = boost::process;
+namespace fs = boost::filesystem;
+
+namespace {
+
+    const fs::path child_flood("./child_flood");
+
+    struct line_counter
+    {
+        std::size_t m_lines;
+        std::size_t m_bad;
+        char        m_expected;
+
+        explicit line_counter(char c) : m_lines(0), m_bad(0), m_expected(c) {}
+
+        void operator()(const char* line, std::size_t len)
+        {
+            ++m_lines;
+            if(len != 63 || std::string(line, len).find_first_not_of(m_expected) != std::string::npos) ++m_bad;
+        }
+    };
+
+}
+
+BOOST_AUTO_TEST_CASE(drains_both_streams)
+{
+    // far more than a pipe holds, so draining only one stream would stall the child
+    const std::size_t bytes = 4 * 1024 * 1024;
+
+    bp::file_descriptor_ray out, err;
+    bp::monitor m(bp::make_child(bp::paths(child_flood), bp::args("4194304"),
+                                 bp::std_out_to(out), bp::std_err_to(err)));
+
+    std::string out_text, err_text;
+    bp::posix::collector c;
+    c.add(out, out_text);
+    c.add(err, err_text);
+    c.run();
+
+    BOOST_CHECK_EQUAL(m.join(), 0);
+    BOOST_CHECK_EQUAL(c.open_sources(), 0u);
+    BOOST_CHECK_EQUAL(out_text.size(), bytes);
+    BOOST_CHECK_EQUAL(err_text.size(), bytes);
+    BOOST_CHECK_EQUAL(out_text.find('e'), std::string::npos);
+    BOOST_CHECK_EQUAL(err_text.find('o'), std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(splits_lines)
+{
+    bp::file_descriptor_ray out, err;
+    bp::monitor m(bp::make_child(bp::paths(child_flood), bp::args("100000"),
+                                 bp::std_out_to(out), bp::std_err_to(err)));
+
+    line_counter out_lines('o'), err_lines('e');
+    bp::posix::collector c;
+    c.add(out, boost::ref(out_lines), bp::posix::collector::lines);
+    c.add(err, boost::ref(err_lines), bp::posix::collector::lines);
+    c.run();
+    m.join();
+
+    // 100000 bytes are 1562 full lines and an unterminated one of 32 bytes
+    BOOST_CHECK_EQUAL(out_lines.m_lines, 1563u);
+    BOOST_CHECK_EQUAL(err_lines.m_lines, 1563u);
+    BOOST_CHECK_EQUAL(out_lines.m_bad, 1u);
+    BOOST_CHECK_EQUAL(err_lines.m_bad, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(many_children_one_thread)
+{
+    const int children = 8;
+
+    std::vector<bp::file_descriptor_ray> rays;
+    for(int i = 0; i < 2 * children; ++i) rays.push_back(bp::file_descriptor_ray());
+    std::vector<std::string> texts(2 * children);
+    std::vector<bp::monitor> monitors;
+
+    for(int i = 0; i < children; ++i)
+    {
+        monitors.push_back(bp::monitor(bp::make_child(bp::paths(child_flood), bp::args("1000000"),
+                                                      bp::std_out_to(rays[2 * i]), bp::std_err_to(rays[2 * i + 1]))));
+    }
+
+    bp::posix::collector c;
+    for(std::size_t i = 0; i < rays.size(); ++i) c.add(rays[i], texts[i]);
+
+    c.run();
+
+    for(std::size_t i = 0; i < monitors.size(); ++i) BOOST_CHECK_EQUAL(monitors[i].join(), 0);
+    for(std::size_t i = 0; i < texts.size(); ++i) BOOST_CHECK_EQUAL(texts[i].size(), 1000000u);
+}
+
+BOOST_AUTO_TEST_CASE(both_backends_drain)
+{
+    typedef bp::posix::collector c;
+    const c::backend_type backends[] = { c::epoll_backend, c::uring_backend };
+
+    for(int b = 0; b < 2; ++b)
+    {
+        bp::file_descriptor_ray out, err;
+        bp::monitor m(bp::make_child(bp::paths(child_flood), bp::args("1000000"),
+                                     bp::std_out_to(out), bp::std_err_to(err)));
+
+        std::string out_text;
+        line_counter err_lines('e');
+        c col(backends[b], 4); // fewer buffers than sources have data
+        col.add(out, out_text);
+        col.add(err, boost::ref(err_lines), c::lines);
+        col.run();
+
+        BOOST_CHECK_EQUAL(m.join(), 0);
+        BOOST_CHECK_EQUAL(out_text.size(), 1000000u);
+        // 1000000 bytes are 15625 full lines
+        BOOST_CHECK_EQUAL(err_lines.m_lines, 15625u);
+        BOOST_CHECK_EQUAL(err_lines.m_bad, 0u);
+    }
+}
+
+namespace {
+
+    /// Lines "<source>:<n>\n" up to about bytes, so a chunk read into the wrong source shows.
+    std::string source_pattern(std::size_t source, std::size_t bytes)
+    {
+        std::string s;
+        for(std::size_t n = 0; s.size() < bytes; ++n) s += boost::lexical_cast<std::string>(source) + ":" + boost::lexical_cast<std::string>(n) + "\n";
+        return s;
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(full_submission_queue_keeps_chunks)
+{
+    typedef bp::posix::collector c;
+
+    // every source has data at once, each completion queues a read and gives back its
+    // chunk, so the 4 entry queue is submitted early again and again with 2 chunks shared
+    const std::size_t sources = 32, bytes = 48 * 1024;
+
+    std::vector<bp::file_descriptor_ray> rays(sources);
+    std::vector<std::string> expected(sources), texts(sources);
+
+    for(std::size_t i = 0; i < sources; ++i)
+    {
+        expected[i] = source_pattern(i, bytes);
+        BOOST_REQUIRE_EQUAL(write(rays[i].m_sink.handle(), expected[i].data(), expected[i].size()), ssize_t(expected[i].size()));
+    }
+
+    c col(c::uring_backend, 2, 4);
+    for(std::size_t i = 0; i < sources; ++i) col.add(rays[i], texts[i]);
+    col.run();
+
+    for(std::size_t i = 0; i < sources; ++i) BOOST_CHECK(texts[i] == expected[i]);
+}
+
+namespace {
+
+    struct exit_recorder
+    {
+        std::vector<pid_t>                  m_pids;
+        std::vector<bp::posix::exit_status> m_statuses;
+
+        void operator()(pid_t pid, bp::posix::exit_status s)
+        {
+            m_pids.push_back(pid);
+            m_statuses.push_back(s);
+        }
+    };
+
+}
+
+BOOST_AUTO_TEST_CASE(feeds_stdin_and_reports_exit)
+{
+    typedef bp::posix::collector c;
+    const c::backend_type backends[] = { c::epoll_backend, c::uring_backend };
+
+    // several pipe sizes, so the write has to wait for the child to read
+    std::string data;
+    for(int i = 0; data.size() < 1000000; ++i) data += boost::lexical_cast<std::string>(i) + '\n';
+
+    for(int b = 0; b < 2; ++b)
+    {
+        bp::file_descriptor_ray in, out;
+        bp::child ch = bp::make_child(bp::paths("/bin/cat"), bp::std_in_from(in), bp::std_out_to(out));
+
+        std::string echoed;
+        exit_recorder exits;
+        c col(backends[b]);
+        col.write(in, data);
+        col.add(out, echoed);
+        col.watch_exit(ch, boost::ref(exits));
+        col.run();
+
+        BOOST_CHECK_EQUAL(col.pending_writes(), 0u);
+        BOOST_CHECK_EQUAL(col.pending_exits(), 0u);
+        BOOST_CHECK(echoed == data);
+        BOOST_REQUIRE_EQUAL(exits.m_pids.size(), 1u);
+        BOOST_CHECK_EQUAL(exits.m_pids[0], ch.handle());
+        BOOST_CHECK(exits.m_statuses[0].success());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(write_ends_when_child_exits)
+{
+    typedef bp::posix::collector c;
+    const c::backend_type backends[] = { c::epoll_backend, c::uring_backend };
+
+    for(int b = 0; b < 2; ++b)
+    {
+        // true never reads its stdin
+        bp::file_descriptor_ray in;
+        bp::child ch = bp::make_child(bp::paths("/bin/true"), bp::std_in_from(in));
+
+        exit_recorder exits;
+        c col(backends[b]);
+        col.write(in, std::string(1 << 20, 'x'));
+        col.watch_exit(ch, boost::ref(exits));
+        col.run();
+
+        BOOST_CHECK_EQUAL(col.pending_writes(), 0u);
+        BOOST_REQUIRE_EQUAL(exits.m_statuses.size(), 1u);
+        BOOST_CHECK_EQUAL(exits.m_statuses[0].code(), 0);
+    }
+}
+
+namespace {
+
+    /// Each line read and each exit reaped launches another echo, adding its stdout and
+    /// exit from within the collector's callbacks.
+    struct spawner
+    {
+        bp::posix::collector&                m_c;
+        std::list<bp::file_descriptor_ray>   m_rays;
+        std::size_t                          m_left, m_lines, m_bad, m_exits;
+
+        spawner(bp::posix::collector& c, std::size_t n) : m_c(c), m_left(n), m_lines(0), m_bad(0), m_exits(0) {}
+
+        void spawn()
+        {
+            m_rays.push_back(bp::file_descriptor_ray());
+            bp::child ch = bp::make_child(bp::paths("/bin/echo"), bp::args("line"), bp::std_out_to(m_rays.back()));
+            m_c.add(m_rays.back(), boost::bind(&spawner::on_line, this, _1, _2), bp::posix::collector::lines);
+            m_c.watch_exit(ch, boost::bind(&spawner::on_exit, this, _1, _2));
+        }
+
+        void on_line(const char* line, std::size_t len)
+        {
+            ++m_lines;
+            if(std::string(line, len) != "line") ++m_bad;
+            if(m_left) { --m_left; spawn(); }
+        }
+
+        void on_exit(pid_t, bp::posix::exit_status)
+        {
+            ++m_exits;
+            if(m_left) { --m_left; spawn(); }
+        }
+    };
+
+}
+
+BOOST_AUTO_TEST_CASE(callbacks_add_sources_and_exits)
+{
+    typedef bp::posix::collector c;
+    const c::backend_type backends[] = { c::epoll_backend, c::uring_backend };
+
+    for(int b = 0; b < 2; ++b)
+    {
+        c col(backends[b]);
+        spawner s(col, 64);
+        s.spawn();
+        col.run();
+
+        BOOST_CHECK_EQUAL(s.m_lines, 65u);
+        BOOST_CHECK_EQUAL(s.m_bad, 0u);
+        BOOST_CHECK_EQUAL(s.m_exits, 65u);
+        BOOST_CHECK_EQUAL(col.open_sources(), 0u);
+        BOOST_CHECK_EQUAL(col.pending_exits(), 0u);
+    }
+}
@@ -0,0 +1,136 @@
+// Boost.Process library
+// Measures adding, looking up and serializing environment variables with the
+// flat environment container against a std::map based one.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include <boost/process/initializers/environment.hpp>
+#include <boost/chrono.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace bp = boost::process;
+namespace bc = boost::chrono;
+
+namespace {
+
+    typedef std::map<std::string, std::string> map_type;
+
+    std::size_t sink = 0; // keeps the optimizer from dropping the measured work
+
+    template<class F> double ns_per_op(int repetitions, std::size_t ops, F f)
+    {
+        bc::steady_clock::time_point start = bc::steady_clock::now();
+
+        for(int i = 0; i < repetitions; ++i) f();
+
+        bc::duration<double, boost::nano> elapsed = bc::steady_clock::now() - start;
+
+        return elapsed.count() / (double(repetitions) * ops);
+    }
+
+    /// what environment::add does
+    template<class Container> struct add
+    {
+        const std::vector<std::string>& m_names;
+        add(const std::vector<std::string>& n) : m_names(n) {}
+        void operator()() const
+        {
+            Container c;
+            for(std::size_t i = 0; i < m_names.size(); ++i)
+            {
+                typename Container::iterator lb = c.lower_bound(m_names[i]);
+                if(lb != c.end() && !c.key_comp()(m_names[i], lb->first)) lb->second = "value";
+                else c.insert(lb, std::make_pair(m_names[i], std::string("value")));
+            }
+            sink += c.size();
+        }
+    };
+
+    template<class Container> struct lookup
+    {
+        const Container& m_c;
+        const std::vector<std::string>& m_names;
+        lookup(const Container& c, const std::vector<std::string>& n) : m_c(c), m_names(n) {}
+        void operator()() const
+        {
+            for(std::size_t i = 0; i < m_names.size(); ++i) sink += m_c.find(m_names[i])->second.size();
+        }
+    };
+
+    struct flat_serialize
+    {
+        const bp::environment& m_e;
+        flat_serialize(const bp::environment& e) : m_e(e) {}
+        void operator()() const { m_e.build_envp(); sink += m_e.m_envp.size(); }
+    };
+
+    struct map_serialize
+    {
+        const map_type& m_m;
+        map_serialize(const map_type& m) : m_m(m) {}
+        void operator()() const
+        {
+            // what environment_to_envp did before the flat container
+            std::vector<char*> envp;
+            for(map_type::const_iterator it = m_m.begin(); it != m_m.end(); ++it)
+            {
+                std::string s = it->first + "=" + it->second;
+                char* p = new char[s.size() + 1];
+                std::strncpy(p, s.c_str(), s.size() + 1);
+                envp.push_back(p);
+            }
+            sink += envp.size();
+            for(std::size_t i = 0; i < envp.size(); ++i) delete [] envp[i];
+        }
+    };
+
+    void report(const std::string& what, std::size_t n, double flat, double map)
+    {
+        std::cout << std::left  << std::setw(12) << what << std::right << std::setw(8) << n
+                  << std::setw(14) << std::fixed << std::setprecision(1) << flat
+                  << std::setw(14) << map << std::endl;
+    }
+
+}
+
+int main()
+{
+    std::cout << std::left << std::setw(12) << "operation" << std::right << std::setw(8) << "vars"
+              << std::setw(14) << "flat ns/var" << std::setw(14) << "map ns/var" << std::endl;
+
+    const std::size_t sizes[] = { 10, 1000, 10000 };
+
+    for(std::size_t s = 0; s < sizeof(sizes)/sizeof(sizes[0]); ++s)
+    {
+        const std::size_t n = sizes[s];
+        const int repetitions = int(200000 / n) + 1;
+
+        std::vector<std::string> names;
+        for(std::size_t i = 0; i < n; ++i) names.push_back("VARIABLE_" + boost::lexical_cast<std::string>(i));
+        std::srand(42);
+        for(std::size_t i = n; i > 1; --i) std::swap(names[i - 1], names[std::rand() % i]); // unsorted like environ
+
+        bp::environment e = bp::environment(bp::clean_environment());
+        map_type m;
+        for(std::size_t i = 0; i < n; ++i) { e.add(bp::env(names[i], std::string("value"))); m[names[i]] = "value"; }
+
+        report("add"      , n, ns_per_op(repetitions, n, add<bp::environment::environment_type>(names)),
+                               ns_per_op(repetitions, n, add<map_type>(names)));
+        report("lookup"   , n, ns_per_op(repetitions, n, lookup<bp::environment::environment_type>(e.m_environment, names)),
+                               ns_per_op(repetitions, n, lookup<map_type>(m, names)));
+        report("serialize", n, ns_per_op(repetitions, n, flat_serialize(e)), ns_per_op(repetitions, n, map_serialize(m)));
+    }
+
+    return (sink != 0)? 0 : 1;
+}
@@ -419,6 +419,41 @@ BOOST_AUTO_TEST_CASE(set_derived_environment_variables)
     }
 }
 
+#if defined(BOOST_POSIX_API)
+
+BOOST_AUTO_TEST_CASE(derived_environment_overlay)
+{
+    fs::path child_process = "child_show_env";
+    BOOST_CHECK_EQUAL(true, fs::exists(child_process));
+
+    bp::environment e = bp::environment(bp::derive_environment())("env1", "val1");
+    e.unset("HOME");
+    e.append_var("PATH", fs::path("/opt/overlay/bin"));
+    // only the changes are recorded, the parent's environment is not copied
+    BOOST_CHECK_EQUAL(e.m_environment.size(), 2u);
+    check_contains(e, "\nPATH=" + std::string(getenv("PATH")) + ":/opt/overlay/bin");
+
+    try
+    {
+        bp::file_descriptor_ray ray;
+        bp::monitor m(bp::make_child(bp::paths(child_process), e, bp::std_out_to(ray)));
+        ray.m_sink.close(); // currently req's manual closing
+        bio::stream_buffer<bio::file_descriptor_source> pstream(ray.m_source);
+        std::ostringstream oss;
+        oss << &pstream;
+        m.join();
+        check_contains(oss.str(), "\nenv1=val1\n");
+        check_contains(oss.str(), ":/opt/overlay/bin\n");
+        check_not_contains(oss.str(), "\nHOME=", __LINE__);
+    }
+    catch (std::exception const& ex)
+    {
+        BOOST_CHECK_MESSAGE(false, std::string("something went wrong: ") + ex.what());
+    }
+}
+
+#endif
+
 #if defined(BOOST_WINDOWS_API)
 
 BOOST_AUTO_TEST_CASE(some_win32_tests)
@@ -0,0 +1,127 @@
+// Boost.Process library
+// Measures failure-heavy loads reported by exception against error_code and expected.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include <boost/process/process.hpp>
+#include <boost/chrono.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace bp = boost::process;
+namespace bc = boost::chrono;
+namespace bs = boost::system;
+
+namespace {
+
+    const char* const missing = "/nonexistent/exe";
+
+    void report(const std::string& name, int n, int failures, bc::steady_clock::duration d)
+    {
+        const double us = bc::duration<double, boost::micro>(d).count();
+
+        std::cout << std::left  << std::setw(36) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << us / n << " us/op " << std::setw(12) << std::setprecision(0) << n / us * 1e6 << " op/s"
+                  << "  (" << failures << " failures)" << std::endl;
+    }
+
+    /// Probes a missing executable, the failure reported by a caught exception.
+    void launch_throwing(int n)
+    {
+        int failures = 0;
+        bc::steady_clock::time_point start = bc::steady_clock::now();
+        for(int i = 0; i < n; ++i)
+        {
+            try
+            {
+                bp::make_child(bp::paths(missing), bp::throw_on_launch_error<>());
+            }
+            catch(const bs::system_error&)
+            {
+                ++failures;
+            }
+        }
+        report("make_child throw_on_launch_error", n, failures, bc::steady_clock::now() - start);
+    }
+
+    void launch_error_code(int n)
+    {
+        int failures = 0;
+        bc::steady_clock::time_point start = bc::steady_clock::now();
+        for(int i = 0; i < n; ++i)
+        {
+            bs::error_code ec;
+            bp::make_child(ec, bp::paths(missing));
+            if(ec) ++failures;
+        }
+        report("make_child(ec)", n, failures, bc::steady_clock::now() - start);
+    }
+
+    void launch_expected(int n)
+    {
+        int failures = 0;
+        bc::steady_clock::time_point start = bc::steady_clock::now();
+        for(int i = 0; i < n; ++i)
+        {
+            if(!bp::make_child_expected(bp::paths(missing))) ++failures;
+        }
+        report("make_child_expected", n, failures, bc::steady_clock::now() - start);
+    }
+
+    /// Joins an already reaped child, where only the reporting differs.
+    void join_throwing(const bp::monitor& m, int n)
+    {
+        int failures = 0;
+        bc::steady_clock::time_point start = bc::steady_clock::now();
+        for(int i = 0; i < n; ++i)
+        {
+            try
+            {
+                m.join();
+            }
+            catch(const bs::system_error&)
+            {
+                ++failures;
+            }
+        }
+        report("join() on reaped child", n, failures, bc::steady_clock::now() - start);
+    }
+
+    void join_error_code(const bp::monitor& m, int n)
+    {
+        int failures = 0;
+        bc::steady_clock::time_point start = bc::steady_clock::now();
+        for(int i = 0; i < n; ++i)
+        {
+            bs::error_code ec;
+            m.join(ec);
+            if(ec) ++failures;
+        }
+        report("join(ec) on reaped child", n, failures, bc::steady_clock::now() - start);
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    const int launches = (argc > 1)? boost::lexical_cast<int>(argv[1]) : 500;
+    const int joins    = (argc > 2)? boost::lexical_cast<int>(argv[2]) : 200000;
+
+    launch_throwing(launches);
+    launch_error_code(launches);
+    launch_expected(launches);
+
+    bp::monitor m(bp::make_child(bp::paths("/bin/true")));
+    m.join();
+
+    join_throwing(m, joins);
+    join_error_code(m, joins);
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+// Boost.Process library
+// Tests the error_code and expected variants of make_child, join and terminate.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE ProcessLib
+
+// Linux requires dynamic linkage of Boost.Test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/process/process.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <cerrno>
+
+#include <signal.h>
+#include <sys/wait.h>
+
+namespace bp = boost::process;
+namespace bs = boost::system;
+
+namespace {
+
+    /// Whether every child of this process has been reaped.
+    bool no_children()
+    {
+        return waitpid(-1, 0, WNOHANG) == -1 && errno == ECHILD;
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE( make_child_reports_failed_exec_in_error_code )
+{
+    bs::error_code ec;
+    bp::child c = bp::make_child(ec, bp::paths("/nonexistent/exe"));
+
+    BOOST_CHECK_EQUAL(ec.value(), ENOENT);
+    BOOST_CHECK(!c);
+    BOOST_CHECK(no_children()); // the failed child was reaped
+}
+
+BOOST_AUTO_TEST_CASE( make_child_clears_error_code_on_success )
+{
+    bs::error_code ec(EINVAL, bs::system_category());
+    bp::child c = bp::make_child(ec, bp::paths("/bin/sh", "/"), bp::args("-c")("exit 3"));
+
+    BOOST_CHECK(!ec);
+    BOOST_REQUIRE(c);
+    BOOST_CHECK_EQUAL(bp::monitor(c).join(ec).code(), 3);
+    BOOST_CHECK(!ec);
+}
+
+BOOST_AUTO_TEST_CASE( error_code_takes_precedence_over_throw_on_launch_error )
+{
+    bs::error_code ec;
+    bp::child c = bp::make_child(ec, bp::paths("/nonexistent/exe"), bp::throw_on_launch_error<>()); // no throw
+
+    BOOST_CHECK_EQUAL(ec.value(), ENOENT);
+    BOOST_CHECK(!c);
+    BOOST_CHECK(no_children());
+}
+
+BOOST_AUTO_TEST_CASE( make_child_expected_holds_child_or_error )
+{
+    bp::expected<bp::child> failed = bp::make_child_expected(bp::paths("/nonexistent/exe"));
+    BOOST_CHECK(!failed);
+    BOOST_CHECK_EQUAL(failed.error().value(), ENOENT);
+    BOOST_CHECK_THROW(failed.value(), bs::system_error);
+
+    bp::expected<bp::child> launched = bp::make_child_expected(bp::paths("/bin/true"));
+    BOOST_REQUIRE(launched);
+    BOOST_CHECK(!launched.error());
+    BOOST_CHECK(bp::monitor(launched.value()).join().success());
+}
+
+BOOST_AUTO_TEST_CASE( join_reports_reaped_child_in_error_code )
+{
+    bp::monitor m(bp::make_child(bp::paths("/bin/true")));
+    m.join();
+
+    bs::error_code ec;
+    BOOST_CHECK_NO_THROW(m.join(ec));
+    BOOST_CHECK_EQUAL(ec.value(), ECHILD);
+
+    bp::expected<bp::posix::exit_status> status = m.join_expected();
+    BOOST_CHECK(!status);
+    BOOST_CHECK_EQUAL(status.error().value(), ECHILD);
+
+    BOOST_CHECK_THROW(m.join(), bs::system_error);
+}
+
+BOOST_AUTO_TEST_CASE( terminate_with_error_code )
+{
+    bp::monitor m(bp::make_child(bp::paths("/bin/sleep"), bp::args("10")));
+
+    bs::error_code ec;
+    m.terminate(ec);
+    BOOST_CHECK(!ec);
+
+    bp::posix::exit_status status = m.join(ec);
+    BOOST_CHECK(!ec);
+    BOOST_CHECK(status.signaled());
+    BOOST_CHECK_EQUAL(status.signal(), SIGKILL);
+
+    m.terminate(ec); // reaped, and the pid not yet reused
+    BOOST_CHECK_EQUAL(ec.value(), ESRCH);
+}
+
+BOOST_AUTO_TEST_CASE( terminate_policy_with_error_code )
+{
+    bp::monitor m(bp::make_child(bp::paths("/bin/sleep"), bp::args("10")));
+
+    bs::error_code ec;
+    bp::posix::exit_status status = m.terminate(bp::posix::termination_policy(SIGTERM, 2000), ec);
+    BOOST_CHECK(!ec);
+    BOOST_CHECK(status.signaled());
+    BOOST_CHECK_EQUAL(status.signal(), SIGTERM);
+
+    bp::expected<bp::posix::exit_status> again = m.terminate_expected(bp::posix::termination_policy(SIGTERM, 100));
+    BOOST_CHECK(!again);
+    BOOST_CHECK_EQUAL(again.error().value(), ECHILD);
+}
+
+BOOST_AUTO_TEST_CASE( scoped_monitor_with_error_code )
+{
+    bs::error_code ec;
+    {
+        bp::posix::scoped_monitor m(bp::make_child(bp::paths("/bin/sleep"), bp::args("10")));
+
+        bp::expected<bp::posix::exit_status> status = m.terminate_expected(bp::posix::termination_policy(SIGKILL));
+        BOOST_REQUIRE(status);
+        BOOST_CHECK_EQUAL(status->signal(), SIGKILL);
+    }
+    BOOST_CHECK(no_children());
+}
@@ -0,0 +1,95 @@
+// Boost.Process library
+// Tests launching executables held in memory.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE ProcessLib
+
+// Linux requires dynamic linkage of Boost.Test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/initializers/exe_from_memory.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/iostreams/stream.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace bp = boost::process;
+namespace fs = boost::filesystem;
+namespace bio = boost::iostreams;
+
+namespace {
+
+    /// The image stays unchanged as long as the process runs, as an embedded one would.
+    const std::vector<char>& image_of(const char* file)
+    {
+        static std::vector<std::vector<char> > images;
+
+        std::ifstream is(file, std::ios::binary);
+        images.push_back(std::vector<char>(std::istreambuf_iterator<char>(is), (std::istreambuf_iterator<char>())));
+        return images.back();
+    }
+
+    std::string read_all(bp::file_descriptor_ray& ray)
+    {
+        ray.m_sink.close();
+        bio::stream<bio::file_descriptor_source> is(ray.m_source);
+        return std::string(std::istreambuf_iterator<char>(is), (std::istreambuf_iterator<char>()));
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(runs_the_image)
+{
+    static const std::vector<char>& sh = image_of("/bin/sh");
+
+    bp::file_descriptor_ray out;
+    bp::monitor m(bp::make_child(bp::posix::exe_from_memory(&sh[0], sh.size(), "helper"), bp::args("-c")("echo $0; pwd"),
+                                 bp::std_out_to(out), bp::throw_on_launch_error<>()));
+
+    BOOST_CHECK_EQUAL(read_all(out), "helper\n" + fs::current_path().string() + "\n");
+    BOOST_CHECK_EQUAL(m.join(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(copies_each_image_once)
+{
+    static const std::vector<char>& t = image_of("/bin/true");
+
+    const std::size_t before = bp::posix::exe_from_memory::cached_images();
+
+    bp::posix::exe_from_memory reused(&t[0], t.size());
+    for(int i = 0; i < 3; ++i)
+    {
+        BOOST_CHECK_EQUAL(bp::monitor(bp::make_child(reused)).join(), 0);
+        BOOST_CHECK_EQUAL(bp::monitor(bp::make_child(bp::posix::exe_from_memory(&t[0], t.size()))).join(), 0);
+    }
+
+    BOOST_CHECK_EQUAL(bp::posix::exe_from_memory::cached_images(), before + 1);
+}
+
+BOOST_AUTO_TEST_CASE(image_is_sealed)
+{
+    static const std::vector<char>& t = image_of("/bin/true");
+
+    bp::posix::exe_from_memory e(&t[0], t.size());
+    bp::monitor(bp::make_child(e)).join();
+
+    BOOST_CHECK_EQUAL(fcntl(e.m_fd, F_GET_SEALS) & F_SEAL_WRITE, F_SEAL_WRITE);
+    BOOST_CHECK_EQUAL(::write(e.m_fd, "x", 1), -1);
+}
+
+BOOST_AUTO_TEST_CASE(script_interpreter_fails)
+{
+    static const char script[] = "#!/bin/sh\nexit 0\n";
+
+    bp::posix::exit_status s = bp::monitor(bp::make_child(bp::posix::exe_from_memory(script, sizeof(script) - 1, "script"))).join();
+    BOOST_CHECK(!s.success());
+}
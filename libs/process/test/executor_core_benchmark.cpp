@@ -0,0 +1,77 @@
+// Boost.Process library
+// Measures launches through the executor core, built header-only as executor_core_benchmark
+// and against the compiled core as executor_core_benchmark_compiled. The twelve initializer
+// sequences below stand in for a code base launching children in many places: compare the
+// size of the two binaries, the compile time of this file, and the launch rates.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/initializers/process_group.hpp>
+#include <boost/chrono.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace bp = boost::process;
+namespace bc = boost::chrono;
+
+namespace {
+
+    const char* const exe = "/bin/true";
+
+    void join(const bp::child& c) { bp::monitor(c).join(); }
+
+    void launch_1()  { join(bp::make_child(bp::paths(exe))); }
+    void launch_2()  { join(bp::make_child(bp::paths(exe), bp::args("a"))); }
+    void launch_3()  { bp::file_descriptor_ray out; join(bp::make_child(bp::paths(exe), bp::args("a"), bp::std_out_to(out))); }
+    void launch_4()  { bp::file_descriptor_ray in, out; join(bp::make_child(bp::paths(exe), bp::args("a"), bp::std_in_from(in), bp::std_out_to(out))); }
+    void launch_5()  { bp::file_descriptor_ray out, err; join(bp::make_child(bp::paths(exe), bp::args("a"), bp::std_out_to(out), bp::std_err_to(err))); }
+    void launch_6()  { join(bp::make_child(bp::paths(exe), bp::throw_on_launch_error<>())); }
+    void launch_7()  { join(bp::make_child(bp::paths(exe), bp::args("a"), bp::throw_on_launch_error<>())); }
+    void launch_8()  { join(bp::make_child(bp::paths(exe), bp::args("a"), bp::posix::new_process_group())); }
+    void launch_9()  { join(bp::make_child(bp::paths(exe), bp::args("a"), bp::std_out_to_path("/dev/null"))); }
+    void launch_10() { join(bp::make_child(bp::paths(exe), bp::args("a"), bp::std_in_from_path("/dev/null"), bp::std_out_to_path("/dev/null"))); }
+    void launch_11() { join(bp::make_child(bp::paths(exe), bp::args("a"), bp::posix::new_process_group(), bp::throw_on_launch_error<>())); }
+    void launch_12() { bp::file_descriptor_ray out; join(bp::make_child(bp::paths(exe), bp::args("a"), bp::std_out_to(out), bp::throw_on_launch_error<>())); }
+
+    void (* const launches[])() = { &launch_1, &launch_2, &launch_3, &launch_4, &launch_5, &launch_6,
+                                    &launch_7, &launch_8, &launch_9, &launch_10, &launch_11, &launch_12 };
+
+    template<class F> void measure(const std::string& name, int n, F f)
+    {
+        bc::steady_clock::time_point start = bc::steady_clock::now();
+
+        for(int i = 0; i < n; ++i) f(i);
+
+        bc::duration<double> elapsed = bc::steady_clock::now() - start;
+
+        std::cout << std::left  << std::setw(40) << name
+                  << std::right << std::setw(10) << std::fixed << std::setprecision(1) << (n / elapsed.count()) << " launches/s  "
+                  << std::setw(10) << std::setprecision(2) << (elapsed.count() * 1e6 / n) << " us/launch" << std::endl;
+    }
+
+    void plain(int)        { launch_2(); }
+    void round_robin(int i) { launches[i % 12](); }
+
+}
+
+int main(int argc, char* argv[])
+{
+    const int n = (argc > 1)? boost::lexical_cast<int>(argv[1]) : 2000;
+
+#if defined(BOOST_PROCESS_SEPARATE_COMPILATION)
+    std::cout << "compiled executor core" << std::endl;
+#else
+    std::cout << "header-only executor core" << std::endl;
+#endif
+
+    measure("paths, args",              n, &plain);
+    measure("12 sequences, round robin", n, &round_robin);
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+// Boost.Process library
+// Tests decoding how a child ended.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE ProcessLib
+
+// Linux requires dynamic linkage of Boost.Test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/monitor_group.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_trivially_copyable.hpp>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace bp = boost::process;
+
+typedef bp::posix::exit_status exit_status;
+
+BOOST_STATIC_ASSERT(boost::is_trivially_copyable<exit_status>::value);
+BOOST_STATIC_ASSERT(sizeof(exit_status) == sizeof(int));
+
+#if !defined(BOOST_NO_CXX11_CONSTEXPR)
+BOOST_STATIC_ASSERT(exit_status(3 << 8).exited() && exit_status(3 << 8).code() == 3);
+BOOST_STATIC_ASSERT(exit_status(SIGKILL).signaled() && exit_status(SIGKILL).signal() == SIGKILL);
+#endif
+
+namespace {
+
+    bp::child shell(const std::string& script)
+    {
+        return bp::make_child(bp::paths("/bin/sh", "/"), bp::args("-c")(script));
+    }
+
+    siginfo_t child_info(int code, int status)
+    {
+        siginfo_t info;
+        std::memset(&info, 0, sizeof(info));
+        info.si_code   = code;
+        info.si_status = status;
+        return info;
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(exited_with_code)
+{
+    exit_status s = bp::monitor(shell("exit 42")).join();
+
+    BOOST_CHECK(s.exited());
+    BOOST_CHECK(!s.signaled());
+    BOOST_CHECK_EQUAL(s.code(), 42);
+    BOOST_CHECK(!s.success());
+    BOOST_CHECK_EQUAL(boost::lexical_cast<std::string>(s), "exit code 42");
+
+    BOOST_CHECK(bp::monitor(shell("exit 0")).join().success());
+}
+
+BOOST_AUTO_TEST_CASE(killed_by_signal)
+{
+    exit_status s = bp::monitor(shell("kill -TERM $$")).join();
+
+    BOOST_CHECK(s.signaled());
+    BOOST_CHECK(!s.exited());
+    BOOST_CHECK_EQUAL(s.signal(), SIGTERM);
+    BOOST_CHECK(!s.core_dumped());
+    BOOST_CHECK_EQUAL(boost::lexical_cast<std::string>(s), "signal " + boost::lexical_cast<std::string>(SIGTERM));
+}
+
+BOOST_AUTO_TEST_CASE(siginfo_matches_waitpid)
+{
+    BOOST_CHECK_EQUAL(exit_status(child_info(CLD_EXITED, 7)).native(), exit_status(7 << 8).native());
+    BOOST_CHECK_EQUAL(exit_status(child_info(CLD_KILLED, SIGINT)).signal(), SIGINT);
+
+    exit_status dumped(child_info(CLD_DUMPED, SIGSEGV));
+    BOOST_CHECK(dumped.signaled());
+    BOOST_CHECK_EQUAL(dumped.signal(), SIGSEGV);
+    BOOST_CHECK(dumped.core_dumped());
+
+    pid_t pid = shell("exit 9").m_pid;
+    siginfo_t info;
+    std::memset(&info, 0, sizeof(info));
+    BOOST_REQUIRE_EQUAL(waitid(P_PID, id_t(pid), &info, WEXITED), 0);
+
+    exit_status s(info);
+    BOOST_CHECK(s.exited());
+    BOOST_CHECK_EQUAL(s.code(), 9);
+}
+
+BOOST_AUTO_TEST_CASE(batch_of_statuses)
+{
+    const int n = 50;
+
+    bp::posix::monitor_group g;
+    for (int i = 0; i < n; ++i) g.add(shell("exit " + boost::lexical_cast<std::string>(i)));
+
+    std::vector<bp::posix::monitor_group::result> done;
+    BOOST_REQUIRE_EQUAL(g.wait_all(done), bp::posix::monitor_group::completed);
+    BOOST_REQUIRE_EQUAL(done.size(), std::size_t(n));
+
+    std::vector<exit_status> statuses(n);
+    for (int i = 0; i < n; ++i) statuses[i] = done[i].m_status;
+
+    int sum = 0;
+    for (int i = 0; i < n; ++i) { BOOST_CHECK(statuses[i].exited()); sum += statuses[i].code(); }
+    BOOST_CHECK_EQUAL(sum, n * (n - 1) / 2);
+}
@@ -0,0 +1,147 @@
+// Boost.Process library
+// Tests leaving registered memory out of forked children.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE ProcessLib
+
+// Linux requires dynamic linkage of Boost.Test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/fork_regions.hpp>
+
+#include <cstring>
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace bp = boost::process;
+
+typedef bp::posix::fork_regions fork_regions;
+
+namespace {
+
+    const std::size_t page        = std::size_t(sysconf(_SC_PAGESIZE));
+    const std::size_t region_size = 16 * page;
+
+    /// An anonymous mapping filled with 'x', unregistered and unmapped at the end.
+    struct region
+    {
+        char* m_p;
+
+        region() : m_p(static_cast<char*>(mmap(0, region_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0)))
+        {
+            BOOST_REQUIRE(m_p != MAP_FAILED);
+            std::memset(m_p, 'x', region_size);
+        }
+
+        ~region()
+        {
+            fork_regions::remove(m_p);
+            munmap(m_p, region_size);
+        }
+    };
+
+    /// Exits the child with the region's first byte, before exec.
+    struct read_in_child : public bp::posix::initializer
+    {
+        typedef bp::initializer_combination::ignore combination_category;
+
+        explicit read_in_child(const char* p) : m_p(p) {}
+
+        template<class Executor> void post_fork_child(Executor&) const
+        {
+            signal(SIGSEGV, SIG_DFL); // not Boost.Test's handler
+            _exit(*static_cast<const volatile char*>(m_p));
+        }
+
+        const char* m_p;
+    };
+
+    bp::posix::exit_status launch_reading(const char* p)
+    {
+        return bp::monitor(bp::make_child(bp::paths("/bin/true", "/"), read_in_child(p))).join();
+    }
+
+    /// A plain fork, not through the executor.
+    bp::posix::exit_status fork_reading(const char* p)
+    {
+        pid_t pid = fork();
+        if(pid == 0)
+        {
+            signal(SIGSEGV, SIG_DFL);
+            _exit(*static_cast<const volatile char*>(p));
+        }
+
+        int status = 0;
+        waitpid(pid, &status, 0);
+        return bp::posix::exit_status(status);
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(around_fork_excludes_executor_forks_only)
+{
+    region r;
+    fork_regions::add(r.m_p, region_size);
+    BOOST_CHECK_EQUAL(fork_regions::size(), region_size);
+
+    bp::posix::exit_status s = launch_reading(r.m_p);
+    BOOST_CHECK(s.signaled());
+    BOOST_CHECK_EQUAL(s.signal(), SIGSEGV);
+
+    // restored once the launch returned
+    BOOST_CHECK_EQUAL(fork_reading(r.m_p).code(), int('x'));
+    BOOST_CHECK_EQUAL(r.m_p[0], 'x');
+}
+
+BOOST_AUTO_TEST_CASE(never_fork_excludes_every_fork)
+{
+    region r;
+    fork_regions::add(r.m_p, region_size, fork_regions::never_fork);
+
+    BOOST_CHECK_EQUAL(fork_reading(r.m_p).signal(), SIGSEGV);
+    BOOST_CHECK_EQUAL(launch_reading(r.m_p).signal(), SIGSEGV);
+
+    fork_regions::remove(r.m_p);
+    BOOST_CHECK_EQUAL(fork_regions::size(), 0u);
+    BOOST_CHECK_EQUAL(fork_reading(r.m_p).code(), int('x'));
+}
+
+BOOST_AUTO_TEST_CASE(wipe_on_fork_zero_fills)
+{
+    region r;
+    fork_regions::add(r.m_p, region_size, fork_regions::wipe_on_fork);
+
+    BOOST_CHECK_EQUAL(fork_reading(r.m_p).code(), 0);
+    BOOST_CHECK_EQUAL(launch_reading(r.m_p).code(), 0);
+    BOOST_CHECK_EQUAL(r.m_p[0], 'x');
+}
+
+BOOST_AUTO_TEST_CASE(aligns_inwards)
+{
+    region r;
+
+    // the partial first page stays, a region within one page is dropped
+    fork_regions::add(r.m_p + 1, region_size - 1, fork_regions::never_fork);
+    BOOST_CHECK_EQUAL(fork_regions::size(), region_size - page);
+    BOOST_CHECK_EQUAL(fork_reading(r.m_p).code(), int('x'));
+    BOOST_CHECK_EQUAL(fork_reading(r.m_p + page).signal(), SIGSEGV);
+    fork_regions::remove(r.m_p + 1);
+
+    fork_regions::add(r.m_p + 1, 100);
+    BOOST_CHECK_EQUAL(fork_regions::size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(trims_before_fork)
+{
+    fork_regions::trim_before_fork(true);
+    BOOST_CHECK_EQUAL(bp::monitor(bp::make_child(bp::paths("/bin/true", "/"))).join(), 0);
+    fork_regions::trim_before_fork(false);
+}
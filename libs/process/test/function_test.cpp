@@ -0,0 +1,117 @@
+// Boost.Process library
+// Tests running a callable in a forked child without exec.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE ProcessLib
+
+// Linux requires dynamic linkage of Boost.Test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/initializers/function.hpp>
+#include <boost/process/posix/initializers/inherit_fds.hpp>
+#include <boost/bind.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/iostreams/stream.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include <unistd.h>
+
+namespace bp = boost::process;
+namespace bio = boost::iostreams;
+
+namespace {
+
+    std::string read_all(bp::file_descriptor_ray& ray)
+    {
+        ray.m_sink.close();
+        bio::stream<bio::file_descriptor_source> is(ray.m_source);
+        return std::string(std::istreambuf_iterator<char>(is), (std::istreambuf_iterator<char>()));
+    }
+
+    int exit_with(int code) { return code; }
+
+    int print(const std::string& s)
+    {
+        std::cout << s << " from " << (getppid() > 1? "child" : "orphan");
+        std::printf(", stdio too\n");
+        return 0;
+    }
+
+    void no_result() {}
+
+    int fail() { throw std::runtime_error("failed in child"); }
+
+    int env_value()
+    {
+        const char* v = std::getenv("FUNCTION_TEST");
+        return v? std::atoi(v) : -1;
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(exits_with_the_result)
+{
+    BOOST_CHECK_EQUAL(bp::monitor(bp::make_child(bp::posix::function(boost::bind(&exit_with, 7)))).join().code(), 7);
+    BOOST_CHECK_EQUAL(bp::monitor(bp::make_child(bp::posix::function(&no_result))).join(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(std_streams_apply)
+{
+    // pending output of the parent is flushed before the fork, not written twice
+    std::cout << "";
+
+    bp::file_descriptor_ray out;
+    bp::monitor m(bp::make_child(bp::posix::function(boost::bind(&print, std::string("hello"))), bp::std_out_to(out)));
+
+    BOOST_CHECK_EQUAL(read_all(out), "hello from child, stdio too\n");
+    BOOST_CHECK_EQUAL(m.join(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(exception_exits_with_1)
+{
+    bp::file_descriptor_ray err;
+    bp::monitor m(bp::make_child(bp::posix::function(&fail), bp::std_err_to(err)));
+
+    BOOST_CHECK_EQUAL(read_all(err), "failed in child\n");
+    BOOST_CHECK_EQUAL(m.join().code(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(launch_error_reporting_does_not_wait_for_exit)
+{
+    // the child blocks until the parent writes, which it can only once make_child returned
+    int fds[2];
+    BOOST_REQUIRE(pipe(fds) == 0);
+    char c;
+    bp::monitor m(bp::make_child(bp::posix::function(boost::bind(&read, fds[0], &c, 1)), bp::throw_on_launch_error<>(),
+                                 bp::posix::inherit_fds(fds[0], fds[0])));
+
+    BOOST_CHECK_EQUAL(write(fds[1], "x", 1), 1);
+    close(fds[0]); close(fds[1]);
+    BOOST_CHECK_EQUAL(m.join().code(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(environment_applies)
+{
+    bp::monitor m(bp::make_child(bp::posix::function(&env_value), bp::environment(bp::clean_environment())("FUNCTION_TEST", "42")));
+    BOOST_CHECK_EQUAL(m.join().code(), 42);
+}
+
+#if !defined(BOOST_NO_CXX11_LAMBDAS)
+BOOST_AUTO_TEST_CASE(lambda)
+{
+    int captured = 5;
+    BOOST_CHECK_EQUAL(bp::monitor(bp::make_child(bp::posix::function([captured]{ return captured + 1; }))).join().code(), 6);
+    BOOST_CHECK_EQUAL(bp::monitor(bp::make_child(bp::posix::function([]{}))).join(), 0);
+}
+#endif
@@ -0,0 +1,127 @@
+// Boost.Process library
+// Measures how closely join_for wakes up to its timeout and to the child's exit.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include <boost/process/process.hpp>
+#include <boost/chrono.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <signal.h>
+
+namespace bp  = boost::process;
+namespace bc  = boost::chrono;
+namespace bio = boost::iostreams;
+
+namespace {
+
+    /// Joins as on a system without pidfds.
+    struct sigchld_monitor : public bp::monitor
+    {
+        sigchld_monitor(const bp::child& c) : bp::monitor(c) {}
+
+        boost::optional<bp::posix::exit_status> join_for(bc::nanoseconds d) const
+        {
+            const timespec deadline = monotonic_after(d.count());
+            int status = 0;
+            if(!try_join_until(-1, &deadline, status)) return boost::none;
+            return bp::posix::exit_status(status);
+        }
+    };
+
+    bp::child sleeper()
+    {
+        return bp::make_child(bp::paths("/bin/sleep", "/"), bp::args("100"));
+    }
+
+    void report(const std::string& name, std::vector<double>& us)
+    {
+        std::sort(us.begin(), us.end());
+
+        double sum = 0;
+        for(std::size_t i = 0; i < us.size(); ++i) sum += us[i];
+
+        std::cout << std::left  << std::setw(44) << name << std::right << std::fixed << std::setprecision(1)
+                  << " mean " << std::setw(8) << sum / us.size()
+                  << " us  median " << std::setw(8) << us[us.size() / 2]
+                  << " us  p99 " << std::setw(8) << us[us.size() * 99 / 100] << " us" << std::endl;
+    }
+
+    /// How far past its timeout join_for returns for a child that keeps running.
+    template<class Monitor> void timeout_overshoot(const std::string& name, bc::microseconds timeout, int n)
+    {
+        Monitor m(sleeper());
+
+        std::vector<double> us;
+        for(int i = 0; i < n; ++i)
+        {
+            bc::steady_clock::time_point start = bc::steady_clock::now();
+            m.join_for(timeout);
+            us.push_back(bc::duration<double, boost::micro>(bc::steady_clock::now() - start - timeout).count());
+        }
+        report(name + " overshoot, " + boost::lexical_cast<std::string>(timeout.count()) + " us", us);
+
+        m.terminate();
+        m.join();
+    }
+
+    /// Time from SIGKILL until join_for returned the status.
+    template<class Monitor> void exit_wakeup(const std::string& name, int n)
+    {
+        std::vector<double> us;
+        for(int i = 0; i < n; ++i)
+        {
+            Monitor m(sleeper());
+
+            bc::steady_clock::time_point start = bc::steady_clock::now();
+            m.terminate();
+            m.join_for(bc::seconds(10));
+            us.push_back(bc::duration<double, boost::micro>(bc::steady_clock::now() - start).count());
+        }
+        report(name + " kill to status", us);
+    }
+
+    struct blocking_monitor : public bp::monitor
+    {
+        blocking_monitor(const bp::child& c) : bp::monitor(c) {}
+
+        bp::posix::exit_status join_for(bc::seconds) const { return join(); }
+    };
+
+}
+
+int main(int argc, char* argv[])
+{
+    const int n = (argc > 1)? boost::lexical_cast<int>(argv[1]) : 200;
+
+    // a child reports how many threads the parent has while it waits
+    bp::file_descriptor_ray ray;
+    bp::monitor probe(bp::make_child(bp::paths("/bin/sh", "/"), bp::args("-c")("sleep 0.1; grep Threads: /proc/$PPID/status"), bp::std_out_to(ray)));
+    ray.m_sink.close();
+    probe.join_for(bc::seconds(10));
+
+    std::string threads;
+    bio::stream<bio::file_descriptor_source> is(ray.m_source);
+    std::getline(is, threads);
+    std::cout << "parent while in join_for: " << threads << std::endl;
+
+    timeout_overshoot<bp::monitor    >("pidfd",   bc::microseconds(1000),  n);
+    timeout_overshoot<bp::monitor    >("pidfd",   bc::microseconds(10000), n / 4);
+    timeout_overshoot<sigchld_monitor>("sigchld", bc::microseconds(1000),  n);
+
+    exit_wakeup<blocking_monitor>("blocking join", n);
+    exit_wakeup<bp::monitor     >("pidfd",         n);
+    exit_wakeup<sigchld_monitor >("sigchld",       n);
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+// Boost.Process library
+// Tests joining children with a timeout or deadline.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE ProcessLib
+
+// Linux requires dynamic linkage of Boost.Test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/process/process.hpp>
+#include <boost/chrono.hpp>
+
+#include <string>
+
+namespace bp = boost::process;
+namespace bc = boost::chrono;
+
+namespace {
+
+    bp::child shell(const std::string& script)
+    {
+        return bp::make_child(bp::paths("/bin/sh", "/"), bp::args("-c")(script));
+    }
+
+    /// Joins as on a system without pidfds.
+    struct sigchld_monitor : public bp::monitor
+    {
+        sigchld_monitor(const bp::child& c) : bp::monitor(c) {}
+
+        boost::optional<bp::posix::exit_status> join_for_ms(int ms) const
+        {
+            int status = 0;
+            if(!try_join(-1, ms, status)) return boost::none;
+            return bp::posix::exit_status(status);
+        }
+    };
+
+}
+
+BOOST_AUTO_TEST_CASE(join_for_times_out)
+{
+    bp::monitor m(bp::make_child(bp::paths("/bin/sleep", "/"), bp::args("10")));
+
+    bc::steady_clock::time_point start = bc::steady_clock::now();
+    boost::optional<bp::posix::exit_status> status = m.join_for(bc::milliseconds(50));
+    bc::steady_clock::duration took = bc::steady_clock::now() - start;
+
+    BOOST_CHECK(!status);
+    BOOST_CHECK(took >= bc::milliseconds(50));
+    BOOST_CHECK(took <  bc::milliseconds(1000));
+
+    // the child is still there to be ended
+    m.terminate();
+    status = m.join_for(bc::seconds(10));
+    BOOST_REQUIRE(status);
+    BOOST_CHECK(status->signaled() && status->signal() == SIGKILL);
+}
+
+BOOST_AUTO_TEST_CASE(join_for_returns_status)
+{
+    bp::monitor m(shell("exit 7"));
+
+    boost::optional<bp::posix::exit_status> status = m.join_for(bc::seconds(10));
+
+    BOOST_REQUIRE(status);
+    BOOST_CHECK(status->exited() && status->code() == 7);
+}
+
+BOOST_AUTO_TEST_CASE(join_until_other_clock)
+{
+    bp::monitor m(bp::make_child(bp::paths("/bin/sleep", "/"), bp::args("10")));
+
+    BOOST_CHECK(!m.join_until(bc::system_clock::now() + bc::milliseconds(20)));
+    BOOST_CHECK(!m.join_until(bc::system_clock::now() - bc::seconds(1))); // passed: only checks
+
+    m.terminate();
+    BOOST_CHECK(m.join_until(bc::steady_clock::now() + bc::seconds(10)));
+}
+
+BOOST_AUTO_TEST_CASE(sigchld_fallback)
+{
+    sigchld_monitor m(shell("sleep 0.1; exit 5"));
+
+    BOOST_CHECK(!m.join_for_ms(10));
+
+    bc::steady_clock::time_point start = bc::steady_clock::now();
+    boost::optional<bp::posix::exit_status> status = m.join_for_ms(10000);
+    bc::steady_clock::duration took = bc::steady_clock::now() - start;
+
+    BOOST_REQUIRE(status);
+    BOOST_CHECK(status->exited() && status->code() == 5);
+    BOOST_CHECK(took < bc::milliseconds(1000));
+}
+
+BOOST_AUTO_TEST_CASE(scoped_monitor_kills_after_deadline)
+{
+    bp::posix::scoped_monitor m(bp::make_child(bp::paths("/bin/sleep", "/"), bp::args("10")));
+
+    boost::optional<bp::posix::exit_status> status = m.join_for(bc::milliseconds(20));
+    if(!status) status = m.terminate(bp::posix::termination_policy(SIGTERM, 1000)(SIGKILL));
+
+    BOOST_CHECK(status->signaled() && status->signal() == SIGTERM);
+}
@@ -0,0 +1,151 @@
+// Boost.Process library
+// Tests choosing between the fork and vfork launch backends.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE ProcessLib
+
+// Linux requires dynamic linkage of Boost.Test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/launch_backend.hpp>
+#include <boost/process/posix/initializers/function.hpp>
+
+#include <string>
+
+#include <signal.h>
+#include <unistd.h>
+
+namespace bp = boost::process;
+
+typedef bp::posix::launch_backend launch_backend;
+
+namespace {
+
+    /// Sets a policy and clears the counters for one test case, back to automatic after it.
+    struct policy_scope
+    {
+        explicit policy_scope(launch_backend::policy_type p)
+        {
+            launch_backend::set_policy(p);
+            launch_backend::reset_counters();
+        }
+
+        ~policy_scope() { launch_backend::set_policy(launch_backend::automatic); }
+    };
+
+    /// Sets the child's exit code from its hook, opting in to the shared memory or not.
+    template<class Category> struct exit_in_child : public bp::posix::initializer
+    {
+        typedef bp::initializer_combination::ignore combination_category;
+        typedef Category child_memory_category;
+
+        template<class Executor> void post_fork_child(Executor&) const { _exit(7); }
+    };
+
+    std::string read_all(bp::file_descriptor_ray& ray)
+    {
+        ray.m_sink.close();
+
+        std::string s;
+        char buffer[256];
+        ssize_t n;
+        while((n = read(ray.m_source.handle(), buffer, sizeof(buffer))) > 0) s.append(buffer, std::size_t(n));
+        return s;
+    }
+
+    int nothing() { return 0; }
+
+}
+
+BOOST_AUTO_TEST_CASE(counts_the_chosen_backend)
+{
+    {
+        policy_scope p(launch_backend::always_fork);
+        BOOST_CHECK_EQUAL(bp::monitor(bp::make_child(bp::paths("/bin/true", "/"))).join(), 0);
+        BOOST_CHECK_EQUAL(launch_backend::launches(launch_backend::fork_backend ), 1u);
+        BOOST_CHECK_EQUAL(launch_backend::launches(launch_backend::vfork_backend), 0u);
+    }
+    {
+        policy_scope p(launch_backend::vfork_when_safe);
+        BOOST_CHECK_EQUAL(bp::monitor(bp::make_child(bp::paths("/bin/true", "/"))).join(), 0);
+        BOOST_CHECK_EQUAL(launch_backend::launches(launch_backend::fork_backend ), 0u);
+        BOOST_CHECK_EQUAL(launch_backend::launches(launch_backend::vfork_backend), 1u);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(initializers_decide_if_memory_may_be_shared)
+{
+    policy_scope p(launch_backend::vfork_when_safe);
+
+    // a hook of its own forks unless it opts in
+    BOOST_CHECK_EQUAL(bp::monitor(bp::make_child(bp::paths("/bin/true", "/"), exit_in_child<bp::posix::child_memory::copied>())).join().code(), 7);
+    BOOST_CHECK_EQUAL(launch_backend::launches(launch_backend::fork_backend), 1u);
+
+    BOOST_CHECK_EQUAL(bp::monitor(bp::make_child(bp::paths("/bin/true", "/"), exit_in_child<bp::posix::child_memory::shared>())).join().code(), 7);
+    BOOST_CHECK_EQUAL(launch_backend::launches(launch_backend::vfork_backend), 1u);
+
+    // a function needs a copy to run in
+    BOOST_CHECK_EQUAL(bp::monitor(bp::make_child(bp::posix::function(&nothing))).join(), 0);
+    BOOST_CHECK_EQUAL(launch_backend::launches(launch_backend::fork_backend), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(vfork_backend_sets_up_the_child)
+{
+    policy_scope p(launch_backend::vfork_when_safe);
+
+    bp::file_descriptor_ray out;
+    bp::monitor m(bp::make_child(bp::paths("/bin/pwd", "/tmp"), bp::std_out_to(out), bp::throw_on_launch_error<>()));
+    BOOST_CHECK_EQUAL(read_all(out), "/tmp\n");
+    BOOST_CHECK_EQUAL(m.join(), 0);
+
+    // the report still comes through the error pipe, from a child that was created
+    BOOST_CHECK_THROW(bp::make_child(bp::paths("/nonexistent/exe"), bp::throw_on_launch_error<>()), bp::posix::launch_error);
+
+    BOOST_CHECK_EQUAL(launch_backend::launches(launch_backend::vfork_backend), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(vfork_backend_keeps_the_signal_mask)
+{
+    policy_scope p(launch_backend::vfork_when_safe);
+
+    sigset_t usr1, old;
+    sigemptyset(&usr1);
+    sigaddset(&usr1, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &usr1, &old);
+
+    // blocked while the child is started, the launching thread's mask from its hooks on
+    bp::file_descriptor_ray out;
+    bp::monitor m(bp::make_child(bp::paths("/bin/grep"), bp::args("SigBlk")("/proc/self/status"), bp::std_out_to(out)));
+    const std::string status = read_all(out);
+    m.join();
+
+    pthread_sigmask(SIG_SETMASK, &old, 0);
+
+    BOOST_CHECK_EQUAL(status, "SigBlk:\t0000000000000200\n");
+}
+
+BOOST_AUTO_TEST_CASE(automatic_by_resident_memory)
+{
+    policy_scope p(launch_backend::automatic);
+    const std::size_t threshold = launch_backend::vfork_threshold();
+
+    BOOST_CHECK(launch_backend::resident_bytes() > 0);
+    BOOST_CHECK_EQUAL(launch_backend::threads(), 1u);
+
+    if(!launch_backend::strict_overcommit())
+    {
+        launch_backend::set_vfork_threshold(std::size_t(-1));
+        BOOST_CHECK_EQUAL(launch_backend::choose(true), launch_backend::fork_backend);
+    }
+
+    launch_backend::set_vfork_threshold(0);
+    BOOST_CHECK_EQUAL(launch_backend::choose(true ), launch_backend::vfork_backend);
+    BOOST_CHECK_EQUAL(launch_backend::choose(false), launch_backend::fork_backend);
+
+    launch_backend::set_vfork_threshold(threshold);
+}
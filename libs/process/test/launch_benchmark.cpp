@@ -0,0 +1,177 @@
+// Boost.Process library
+// Measures the cost of launching and joining children.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/fork_regions.hpp>
+#include <boost/process/posix/launch_backend.hpp>
+#include <boost/process/posix/initializers/function.hpp>
+#if defined(__linux__)
+#   include <boost/process/posix/initializers/exe_from_memory.hpp>
+#endif
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/mman.h>
+
+namespace bp = boost::process;
+namespace bc = boost::chrono;
+
+namespace {
+
+    /// Runs f rounds times for n launches in total.
+    template<class F> void measure(const std::string& name, int n, F f, int rounds = -1)
+    {
+        if(rounds == -1) rounds = n;
+
+        bc::steady_clock::time_point start = bc::steady_clock::now();
+
+        for(int i = 0; i < rounds; ++i) f();
+
+        bc::duration<double> elapsed = bc::steady_clock::now() - start;
+
+        std::cout << std::left  << std::setw(40) << name
+                  << std::right << std::setw(10) << std::fixed << std::setprecision(1) << (n / elapsed.count()) << " launches/s  "
+                  << std::setw(10) << std::setprecision(2) << (elapsed.count() * 1e6 / n) << " us/launch" << std::endl;
+    }
+
+    void plain_launch()
+    {
+        bp::monitor(bp::make_child(bp::paths("/bin/true", "/"))).join();
+    }
+
+    /// The exe and working directory are opened once, later launches exec by fd.
+    void reused_paths_launch()
+    {
+        static const bp::paths p("/bin/true", "/");
+        bp::monitor(bp::make_child(p)).join();
+    }
+
+#if defined(__linux__)
+    /// /bin/true run from a memfd, as an embedded helper would be.
+    void memory_launch()
+    {
+        static std::ifstream is("/bin/true", std::ios::binary);
+        static const std::vector<char> image((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+
+        bp::monitor(bp::make_child(bp::posix::exe_from_memory(&image[0], image.size(), "true"))).join();
+    }
+#endif
+
+    int nothing() { return 0; }
+
+    /// Forks and runs a function, no exec.
+    void function_launch()
+    {
+        bp::monitor(bp::make_child(bp::posix::function(&nothing))).join();
+    }
+
+    void reported_launch()
+    {
+        bp::monitor(bp::make_child(bp::paths("/bin/true", "/"), bp::throw_on_launch_error<>())).join();
+    }
+
+    /// Splits the launches over threads, each with its own initializers.
+    struct threaded_launch
+    {
+        int m_threads; int m_launches;
+        threaded_launch(int threads, int launches) : m_threads(threads), m_launches(launches) {}
+
+        static void launch_n(int n) { for(int i = 0; i < n; ++i) reported_launch(); }
+
+        void operator()() const
+        {
+            boost::thread_group group;
+            for(int t = 0; t < m_threads; ++t) group.create_thread(boost::bind(&launch_n, m_launches / m_threads));
+            group.join_all();
+        }
+    };
+
+    typedef bp::posix::launch_backend launch_backend;
+
+    /// Launches with each backend forced.
+    void launches_by_backend(const std::string& name, int n)
+    {
+        launch_backend::set_policy(launch_backend::always_fork);
+        measure(name + ", fork backend", n, plain_launch);
+
+        launch_backend::set_policy(launch_backend::vfork_when_safe);
+        measure(name + ", vfork backend", n, plain_launch);
+
+        launch_backend::set_policy(launch_backend::automatic);
+    }
+
+    /// Launches with mb megabytes of touched anonymous memory in the parent, registered with
+    /// fork_regions or not, and with the vfork backend.
+    void launches_with_resident(int n, std::size_t mb)
+    {
+        typedef bp::posix::fork_regions fork_regions;
+
+        const std::size_t len = mb << 20;
+        void* p = mmap(0, len, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        if(p == MAP_FAILED) { std::cout << mb << " MB: mmap failed" << std::endl; return; }
+        std::memset(p, 1, len);
+
+        const std::string resident = boost::lexical_cast<std::string>(mb) + " MB resident";
+
+        launches_by_backend(resident, n);
+
+        // fork_regions only matter to forks
+        launch_backend::set_policy(launch_backend::always_fork);
+
+        measure(resident + ", not registered", n, plain_launch);
+
+        fork_regions::add(p, len);
+        measure(resident + ", around_fork", n, plain_launch);
+        fork_regions::remove(p);
+
+        fork_regions::add(p, len, fork_regions::never_fork);
+        measure(resident + ", never_fork", n, plain_launch);
+        fork_regions::remove(p);
+
+        launch_backend::set_policy(launch_backend::automatic);
+
+        munmap(p, len);
+    }
+
+}
+
+int main(int argc, char *argv[])
+{
+    const int n         = (argc > 1)? boost::lexical_cast<int>(argv[1]) : 1000;
+    const std::size_t mb = (argc > 2)? boost::lexical_cast<std::size_t>(argv[2]) : 2048;
+
+    measure("make_child+join"                      , n, plain_launch   );
+    measure("make_child+join, reused paths"         , n, reused_paths_launch);
+#if defined(__linux__)
+    measure("make_child+join, exe_from_memory"      , n, memory_launch);
+#endif
+    measure("make_child+join, function"             , n, function_launch);
+    measure("make_child+join, throw_on_launch_error", n, reported_launch);
+    launches_by_backend("make_child+join", n);
+
+    // launches/s over all threads, n launches per round
+    for(int threads = 1; threads <= 32; threads *= 2)
+    {
+        measure(boost::lexical_cast<std::string>(threads) + " thread(s), throw_on_launch_error", n / threads * threads, threaded_launch(threads, n), 1);
+    }
+
+    // fork copies the page tables of all resident memory
+    for(std::size_t m = 256; m <= mb; m *= 2) launches_with_resident((std::min)(n, 200), m);
+
+    return 0;
+}
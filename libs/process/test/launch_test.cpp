@@ -0,0 +1,304 @@
+// Boost.Process library
+// Tests related to launching children and reporting launch failures.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE ProcessLib
+
+// Linux requires dynamic linkage of Boost.Test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/initializers/inherit_fds.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+
+#include <csignal>
+#include <fstream>
+#include <string>
+
+#include <fcntl.h>
+
+namespace bp = boost::process;
+namespace fs = boost::filesystem;
+namespace bio = boost::iostreams;
+
+#if defined(BOOST_POSIX_API)
+
+BOOST_AUTO_TEST_CASE(report_failed_exec)
+{
+    try
+    {
+        bp::make_child(bp::paths("./does_not_exist", "."), bp::throw_on_launch_error<>());
+        BOOST_CHECK_MESSAGE(false, "launching a non existing executable did not throw");
+    }
+    catch (bp::posix::launch_error const& ex)
+    {
+        BOOST_CHECK_EQUAL(ex.code().value(), ENOENT);
+        BOOST_CHECK_EQUAL(ex.stage(), bp::posix::launch_report::exec);
+        BOOST_CHECK_EQUAL(ex.initializer(), -1);
+        BOOST_CHECK_EQUAL(std::string(ex.context()), "execve: ./does_not_exist");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(report_failed_chdir)
+{
+    try
+    {
+        bp::make_child(bp::throw_on_launch_error<>(), bp::paths("/bin/true", "/does/not/exist"));
+        BOOST_CHECK_MESSAGE(false, "launching in a non existing directory did not throw");
+    }
+    catch (bp::posix::launch_error const& ex)
+    {
+        BOOST_CHECK_EQUAL(ex.code().value(), ENOENT);
+        BOOST_CHECK_EQUAL(ex.stage(), bp::posix::launch_report::post_fork_child);
+        BOOST_CHECK_EQUAL(ex.initializer(), 1);
+        BOOST_CHECK_EQUAL(std::string(ex.context()), "chdir: /does/not/exist");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(report_failed_open)
+{
+    try
+    {
+        bp::make_child(bp::paths("/bin/true", "/"), bp::std_out_to_path("/does/not/exist"), bp::throw_on_launch_error<>());
+        BOOST_CHECK_MESSAGE(false, "redirecting to a non existing directory did not throw");
+    }
+    catch (bp::posix::launch_error const& ex)
+    {
+        BOOST_CHECK_EQUAL(ex.code().value(), ENOENT);
+        BOOST_CHECK_EQUAL(ex.stage(), bp::posix::launch_report::post_fork_child);
+        BOOST_CHECK_EQUAL(ex.initializer(), 1);
+        BOOST_CHECK_EQUAL(std::string(ex.context()), "open: /does/not/exist");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(no_report_on_success)
+{
+    bp::monitor m(bp::make_child(bp::paths("/bin/true", "/"), bp::throw_on_launch_error<>()));
+    BOOST_CHECK_EQUAL(m.join(), 0);
+}
+
+namespace {
+
+    /// The fds the child sees, ls itself has the directory open as 3.
+    std::string child_fds()
+    {
+        bp::file_descriptor_ray ray;
+        bp::monitor m(bp::make_child(bp::paths("/bin/ls", "/"), bp::args("/proc/self/fd"), bp::std_out_to(ray), bp::throw_on_launch_error<>()));
+        ray.m_sink.close();
+        bio::stream<bio::file_descriptor_source> is(ray.m_source);
+        std::string fds(std::istreambuf_iterator<char>(is), (std::istreambuf_iterator<char>()));
+        m.join();
+        return fds;
+    }
+
+    struct launcher
+    {
+        int* m_leaks;
+        explicit launcher(int* leaks) : m_leaks(leaks) {}
+        void operator()() const
+        {
+            for (int i = 0; i < 25; ++i) if (child_fds() != "0\n1\n2\n3\n") ++*m_leaks;
+        }
+    };
+
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_launches_do_not_leak_fds)
+{
+    if (!fs::exists("/proc/self/fd")) return;
+
+    const int threads = 8;
+    int leaks[threads] = {};
+
+    boost::thread_group group;
+    for (int i = 0; i < threads; ++i) group.create_thread(launcher(&leaks[i]));
+    group.join_all();
+
+    for (int i = 0; i < threads; ++i) BOOST_CHECK_EQUAL(leaks[i], 0);
+}
+
+BOOST_AUTO_TEST_CASE(high_fds_are_not_inherited)
+{
+    if (!fs::exists("/proc/self/fd")) return;
+
+    int fd = open("/dev/null", O_RDONLY);
+    int high = fcntl(fd, F_DUPFD, 1500); // not close-on-exec, beyond the old fixed limit of 1000
+    close(fd);
+
+    if (high != -1)
+    {
+        BOOST_CHECK_EQUAL(child_fds(), "0\n1\n2\n3\n");
+        close(high);
+    }
+}
+
+namespace {
+
+    std::string read_all(bp::file_descriptor_ray& ray)
+    {
+        if (ray.m_sink.is_open()) ray.m_sink.close();
+        bio::stream<bio::file_descriptor_source> is(ray.m_source);
+        return std::string(std::istreambuf_iterator<char>(is), (std::istreambuf_iterator<char>()));
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(inherit_fds_swapped)
+{
+    bp::file_descriptor_ray a, b, out;
+
+    // move the sinks to free fds the shell can redirect to, mapped onto each other as a cycle
+    int fds[2] = {-1, -1};
+    bp::file_descriptor_ray* rays[2] = {&a, &b};
+    for (int n = 0; n < 2; ++n)
+    {
+        for (int fd = 9; fd > 2 && fds[n] == -1; --fd) if (fcntl(fd, F_GETFD) == -1) fds[n] = fd;
+        BOOST_REQUIRE(fds[n] != -1);
+
+        dup2(rays[n]->m_sink.handle(), fds[n]);
+        rays[n]->m_sink.close();
+    }
+
+    const std::string script = "echo a >&" + boost::lexical_cast<std::string>(fds[0]) + "; echo b >&" + boost::lexical_cast<std::string>(fds[1]) + "; echo done";
+    bp::monitor m(bp::make_child(bp::paths("/bin/sh", "/"), bp::args("-c")(script),
+                                 bp::posix::inherit_fds(fds[0], fds[1])(fds[1], fds[0]), bp::std_out_to(out), bp::throw_on_launch_error<>()));
+    close(fds[0]); close(fds[1]);
+
+    BOOST_CHECK_EQUAL(read_all(out), "done\n");
+    BOOST_CHECK_EQUAL(read_all(a), "b\n");
+    BOOST_CHECK_EQUAL(read_all(b), "a\n");
+    BOOST_CHECK_EQUAL(m.join(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(inherit_fds_same_number)
+{
+    bp::file_descriptor_ray a, out;
+    const int fd = a.m_sink.handle(); // close-on-exec, kept under its number
+
+    bp::monitor m(bp::make_child(bp::paths("/bin/ls", "/"), bp::args("/proc/self/fd/" + boost::lexical_cast<std::string>(fd)),
+                                 bp::posix::inherit_fds(fd, fd), bp::std_out_to(out)));
+
+    BOOST_CHECK_EQUAL(m.join(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(inherit_fds_from_a_std_fd)
+{
+    const fs::path log = fs::temp_directory_path() / fs::unique_path();
+    const int log_fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    BOOST_REQUIRE(log_fd != -1);
+
+    // the parent's stderr is the log while launching, the child gets it as fd 3 and /dev/null as 2
+    const int saved_err = dup(STDERR_FILENO);
+    dup2(log_fd, STDERR_FILENO);
+    close(log_fd);
+
+    bp::file_descriptor_ray out;
+    bp::monitor m(bp::make_child(bp::paths("/bin/sh", "/"), bp::args("-c")("readlink /proc/self/fd/3"),
+                                 bp::posix::inherit_fds(STDERR_FILENO, 3), bp::std_out_to(out)));
+
+    dup2(saved_err, STDERR_FILENO);
+    close(saved_err);
+
+    BOOST_CHECK_EQUAL(read_all(out), log.string() + "\n");
+    BOOST_CHECK_EQUAL(m.join(), 0);
+    fs::remove(log);
+}
+
+BOOST_AUTO_TEST_CASE(inherit_fds_twice_throws)
+{
+    BOOST_CHECK_THROW(bp::make_child(bp::paths("/bin/true", "/"), bp::posix::inherit_fds(0, 5)(1, 5)), std::invalid_argument);
+#if !defined(BOOST_NO_CXX11_HDR_INITIALIZER_LIST)
+    BOOST_CHECK_THROW(bp::make_child(bp::paths("/bin/true", "/"), bp::posix::inherit_fds({{0, 5}, {1, 5}})), std::invalid_argument);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(socket_activation)
+{
+    bp::file_descriptor_ray a, out;
+
+    bp::monitor m(bp::make_child(bp::paths("/bin/sh", "/"),
+                                 bp::args("-c")("echo $LISTEN_FDS $((LISTEN_PID == $$)) $LISTEN_FDNAMES $HOME; echo via 3 >&3"),
+                                 bp::environment(bp::clean_environment())("HOME", "/home"),
+                                 bp::posix::listen_fds(std::vector<int>(1, a.m_sink.handle()), std::vector<std::string>(1, "http")),
+                                 bp::std_out_to(out), bp::throw_on_launch_error<>()));
+
+    BOOST_CHECK_EQUAL(read_all(out), "1 1 http /home\n");
+    BOOST_CHECK_EQUAL(read_all(a), "via 3\n");
+    BOOST_CHECK_EQUAL(m.join(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(sigpipe_disposition_untouched)
+{
+    void (*previous)(int) = std::signal(SIGPIPE, SIG_DFL);
+
+    bp::monitor(bp::make_child(bp::paths("/bin/true", "/"), bp::throw_on_launch_error<>())).join();
+
+    BOOST_CHECK(std::signal(SIGPIPE, previous) == SIG_DFL);
+}
+
+namespace {
+
+    int run(const bp::paths& p)
+    {
+        return bp::monitor(bp::make_child(p, bp::throw_on_launch_error<>())).join();
+    }
+
+    void write_script(const fs::path& file, const std::string& text)
+    {
+        fs::remove(file);
+        std::ofstream(file.string().c_str()) << text;
+        fs::permissions(file, fs::owner_all);
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(paths_keep_running_the_opened_file)
+{
+    const fs::path dir = fs::temp_directory_path() / fs::unique_path();
+    fs::create_directory(dir);
+    fs::copy_file("/bin/true", dir / "exe");
+
+    bp::paths p(dir / "exe");
+    BOOST_CHECK_EQUAL(run(p), 0);
+
+    // replaced after p opened it, p still has the old file open
+    fs::rename(dir / "exe", dir / "moved");
+    write_script(dir / "exe", "#!/bin/sh\nexit 4\n");
+    if(p.m_handles->m_exe_fd != -1) BOOST_CHECK_EQUAL(run(p), 0);
+
+    // a script is exec'd by path, its interpreter cannot open the close-on-exec fd
+    BOOST_CHECK_EQUAL(run(bp::paths(dir / "exe")) >> 8, 4);
+
+    fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_CASE(paths_relative_to_working_dir)
+{
+    BOOST_CHECK_EQUAL(run(bp::paths("true", "/bin")), 0);
+    BOOST_CHECK_EQUAL(run(bp::paths("bin/true", "/")), 0);
+}
+
+BOOST_AUTO_TEST_CASE(inherit_fds_onto_the_exe_fd)
+{
+    bp::paths p("/bin/sh", "/");
+    bp::monitor(bp::make_child(p, bp::args("-c")("true"))).join();
+    if(!p.m_handles || p.m_handles->m_exe_fd == -1) return;
+
+    // the child number is the one the executor keeps the exe open as
+    const int n = p.m_handles->m_exe_fd;
+    bp::file_descriptor_ray out;
+    bp::monitor m(bp::make_child(p, bp::args("-c")("echo via " + boost::lexical_cast<std::string>(n) + " >&" + boost::lexical_cast<std::string>(n)),
+                                 bp::posix::inherit_fds(out.m_sink.handle(), n), bp::throw_on_launch_error<>()));
+
+    BOOST_CHECK_EQUAL(read_all(out), "via " + boost::lexical_cast<std::string>(n) + "\n");
+    BOOST_CHECK_EQUAL(m.join(), 0);
+}
+
+#endif
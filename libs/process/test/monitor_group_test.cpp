@@ -0,0 +1,110 @@
+// Boost.Process library
+// Tests waiting for groups of children.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE ProcessLib
+
+// Linux requires dynamic linkage of Boost.Test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/monitor_group.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <vector>
+
+namespace bp = boost::process;
+
+typedef bp::posix::monitor_group group;
+
+namespace {
+
+    bp::child sleeper(const char* seconds)
+    {
+        return bp::make_child(bp::paths("/bin/sleep", "/"), bp::args(seconds));
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(wait_any_returns_first)
+{
+    group g;
+    bp::child slow = sleeper("10");
+    bp::child fast = sleeper("0.05");
+    g.add(slow);
+    g.add(fast);
+
+    std::vector<group::result> done;
+    BOOST_CHECK_EQUAL(g.wait_any(done), group::completed);
+    BOOST_REQUIRE_EQUAL(done.size(), 1u);
+    BOOST_CHECK_EQUAL(done[0].m_pid, fast.handle());
+    BOOST_CHECK_EQUAL(done[0].m_status, 0);
+    BOOST_CHECK_EQUAL(g.running(), 1u);
+
+    g.signal_all(SIGKILL);
+    BOOST_CHECK_EQUAL(g.wait_all(done), group::completed);
+    BOOST_REQUIRE_EQUAL(done.size(), 2u);
+    BOOST_CHECK(WIFSIGNALED(done[1].m_status) && WTERMSIG(done[1].m_status) == SIGKILL);
+}
+
+BOOST_AUTO_TEST_CASE(wait_all_times_out)
+{
+    group g;
+    g.add(sleeper("10"));
+
+    std::vector<group::result> done;
+    BOOST_CHECK_EQUAL(g.wait_all(done, 50), group::timed_out);
+    BOOST_CHECK(done.empty());
+    BOOST_CHECK_EQUAL(g.wait_any(done, 0), group::timed_out);
+
+    g.signal_all(SIGKILL);
+    BOOST_CHECK_EQUAL(g.wait_all(done), group::completed);
+    BOOST_CHECK_EQUAL(g.running(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(kill_rest_on_first_failure)
+{
+    group g;
+    for (int i = 0; i < 3; ++i) g.add(sleeper("10"));
+    g.add(bp::make_child(bp::paths("/bin/false", "/")));
+
+    std::vector<group::result> done;
+    BOOST_CHECK_EQUAL(g.wait_all_or_kill(done, SIGTERM, 5000), group::completed);
+    BOOST_REQUIRE_EQUAL(done.size(), 4u);
+
+    BOOST_CHECK(WIFEXITED(done[0].m_status) && WEXITSTATUS(done[0].m_status) == 1);
+    for (std::size_t i = 1; i < done.size(); ++i) BOOST_CHECK(WIFSIGNALED(done[i].m_status) && WTERMSIG(done[i].m_status) == SIGTERM);
+}
+
+BOOST_AUTO_TEST_CASE(cancel_from_other_thread)
+{
+    group g;
+    g.add(sleeper("10"));
+
+    boost::thread canceller(boost::bind(&group::cancel, &g));
+
+    std::vector<group::result> done;
+    BOOST_CHECK_EQUAL(g.wait_all(done, 5000), group::cancelled);
+    canceller.join();
+
+    g.signal_all(SIGKILL);
+    BOOST_CHECK_EQUAL(g.wait_all(done), group::completed);
+}
+
+BOOST_AUTO_TEST_CASE(many_children)
+{
+    const std::size_t n = 200;
+
+    group g;
+    for (std::size_t i = 0; i < n; ++i) g.add(bp::make_child(bp::paths("/bin/true", "/")));
+
+    std::vector<group::result> done;
+    BOOST_CHECK_EQUAL(g.wait_all(done), group::completed);
+    BOOST_REQUIRE_EQUAL(done.size(), n);
+    for (std::size_t i = 0; i < n; ++i) BOOST_CHECK_EQUAL(done[i].m_status, 0);
+}
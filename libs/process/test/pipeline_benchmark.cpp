@@ -0,0 +1,91 @@
+// Boost.Process library
+// Measures pipelines launched with posix::pipeline against the same pipelines
+// run by /bin/sh -c: the launch cost of "true | true | true" and the
+// throughput of "head -c N /dev/zero | cat | wc -c", 1 GB by default.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/pipeline.hpp>
+#include <boost/chrono.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace bp = boost::process;
+namespace bc = boost::chrono;
+
+namespace {
+
+    template<class F> void measure(const std::string& name, int n, double bytes, F f)
+    {
+        bc::steady_clock::time_point start = bc::steady_clock::now();
+
+        for(int i = 0; i < n; ++i) f();
+
+        bc::duration<double> elapsed = bc::steady_clock::now() - start;
+
+        std::cout << std::left  << std::setw(40) << name
+                  << std::right << std::setw(10) << std::fixed << std::setprecision(1) << (elapsed.count() * 1e6 / n) << " us/pipeline";
+        if(bytes) std::cout << std::setw(10) << (bytes * n / elapsed.count() / (1 << 20)) << " MB/s";
+        std::cout << std::endl;
+    }
+
+    void trues_pipeline()
+    {
+        bp::posix::pipeline p;
+        bp::make_child(bp::paths("/bin/true"), p.stage());
+        bp::make_child(bp::paths("/bin/true"), p.stage());
+        bp::make_child(bp::paths("/bin/true"), p.last_stage());
+        p.monitor().join();
+    }
+
+    void trues_shell()
+    {
+        bp::monitor(bp::make_child(bp::paths("/bin/sh"), bp::args("-c")("true | true | true"))).join();
+    }
+
+    struct copy_pipeline
+    {
+        std::string m_bytes; int m_pipe_size;
+        copy_pipeline(const std::string& b, int s) : m_bytes(b), m_pipe_size(s) {}
+        void operator()() const
+        {
+            bp::posix::pipeline p(m_pipe_size);
+            bp::make_child(bp::paths("/usr/bin/head"), bp::args("-c")(m_bytes), bp::std_in_from_path("/dev/zero"), p.stage());
+            bp::make_child(bp::paths("/bin/cat"), p.stage());
+            bp::make_child(bp::paths("/usr/bin/wc"), bp::args("-c"), p.last_stage());
+            p.monitor().join();
+        }
+    };
+
+    struct copy_shell
+    {
+        std::string m_command;
+        explicit copy_shell(const std::string& b) : m_command("head -c " + b + " /dev/zero | cat | wc -c >/dev/null") {}
+        void operator()() const
+        {
+            bp::monitor(bp::make_child(bp::paths("/bin/sh"), bp::args("-c")(m_command))).join();
+        }
+    };
+
+}
+
+int main(int argc, char *argv[])
+{
+    const std::string bytes = (argc > 1)? argv[1] : "1073741824";
+    const int n             = (argc > 2)? boost::lexical_cast<int>(argv[2]) : 200;
+    const double size       = boost::lexical_cast<double>(bytes);
+
+    measure("pipeline, true | true | true"      , n, 0, trues_pipeline);
+    measure("sh -c, true | true | true"         , n, 0, trues_shell);
+    measure("pipeline, head | cat | wc"         , 3, size, copy_pipeline(bytes, 0));
+    measure("pipeline 1 MB pipes, head | cat | wc", 3, size, copy_pipeline(bytes, 1 << 20));
+    measure("sh -c, head | cat | wc"            , 3, size, copy_shell(bytes));
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+// Boost.Process library
+// Tests connecting children to pipelines.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE ProcessLib
+
+// Linux requires dynamic linkage of Boost.Test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/pipeline.hpp>
+#include <boost/iostreams/stream.hpp>
+
+#include <string>
+#include <vector>
+
+namespace bp  = boost::process;
+namespace bio = boost::iostreams;
+
+namespace {
+
+    std::string read_all(bp::file_descriptor_ray& ray)
+    {
+        ray.m_sink.close();
+        bio::stream<bio::file_descriptor_source> is(ray.m_source);
+
+        return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(three_stages)
+{
+    bp::file_descriptor_ray ray;
+    bp::posix::pipeline p;
+
+    bp::make_child(bp::paths("/usr/bin/head"), bp::args("-c")("1000000"), bp::std_in_from_path("/dev/zero"), p.stage());
+    bp::make_child(bp::paths("/bin/cat"), p.stage());
+    bp::make_child(bp::paths("/usr/bin/wc"), bp::args("-c"), bp::std_out_to(ray), p.last_stage());
+
+    // wc only gets EOF if the parent closed its copies of the pipe ends
+    BOOST_CHECK_EQUAL(read_all(ray), "1000000\n");
+    BOOST_CHECK_EQUAL(p.stages().size(), 3u);
+    BOOST_CHECK_EQUAL(p.monitor().join(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(resized_pipes)
+{
+    bp::file_descriptor_ray ray;
+    bp::posix::pipeline p(1 << 20);
+
+    bp::make_child(bp::paths("/usr/bin/head"), bp::args("-c")("5000000"), bp::std_in_from_path("/dev/zero"), p.stage());
+    bp::make_child(bp::paths("/usr/bin/wc"), bp::args("-c"), bp::std_out_to(ray), p.last_stage());
+
+    BOOST_CHECK_EQUAL(read_all(ray), "5000000\n");
+    BOOST_CHECK_EQUAL(p.monitor().join(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(statuses_of_all_stages)
+{
+    bp::posix::pipeline p;
+
+    bp::make_child(bp::paths("/bin/false"), p.stage());
+    bp::make_child(bp::paths("/bin/true"), p.last_stage());
+
+    std::vector<bp::posix::exit_status> statuses = p.monitor().join_all();
+
+    BOOST_REQUIRE_EQUAL(statuses.size(), 2u);
+    BOOST_CHECK(statuses[0].exited() && statuses[0].code() == 1);
+    BOOST_CHECK(statuses[1].success());
+}
+
+BOOST_AUTO_TEST_CASE(failed_stage_closes_its_ends)
+{
+    bp::file_descriptor_ray ray;
+    bp::posix::pipeline p;
+
+    bp::make_child(bp::paths("/usr/bin/head"), bp::args("-c")("10"), bp::std_in_from_path("/dev/zero"), p.stage());
+    BOOST_CHECK_THROW(bp::make_child(bp::throw_on_launch_error<>(), bp::paths("./does_not_exist"), p.stage()), bp::posix::launch_error);
+    bp::make_child(bp::paths("/usr/bin/wc"), bp::args("-c"), bp::std_out_to(ray), p.last_stage());
+
+    // the stage that failed to exec never ran, wc reads the EOF of its pipe
+    BOOST_CHECK_EQUAL(read_all(ray), "0\n");
+    p.monitor().join();
+}
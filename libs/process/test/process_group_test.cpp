@@ -0,0 +1,109 @@
+// Boost.Process library
+// Tests process group and session initializers and signalling whole groups.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE ProcessLib
+
+// Linux requires dynamic linkage of Boost.Test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/initializers/process_group.hpp>
+#include <boost/process/posix/process_group_monitor.hpp>
+#include <boost/chrono.hpp>
+#include <boost/iostreams/stream.hpp>
+
+#include <string>
+#include <vector>
+
+#include <errno.h>
+#include <signal.h>
+
+namespace bp  = boost::process;
+namespace bc  = boost::chrono;
+namespace bio = boost::iostreams;
+
+typedef bp::posix::process_group_monitor group_monitor;
+
+namespace {
+
+    bp::child sleeper()
+    {
+        return bp::make_child(bp::paths("/bin/sleep", "/"), bp::args("30"), bp::posix::new_process_group());
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(join_existing_group)
+{
+    bp::child leader = sleeper();
+    bp::child a = bp::make_child(bp::paths("/bin/sleep", "/"), bp::args("30"), bp::posix::join_process_group(leader));
+    bp::child b = bp::make_child(bp::paths("/bin/sleep", "/"), bp::args("30"), bp::posix::join_process_group(leader.m_pid));
+
+    BOOST_CHECK_EQUAL(getpgid(leader.m_pid), leader.m_pid);
+    BOOST_CHECK_EQUAL(getpgid(a.m_pid), leader.m_pid);
+    BOOST_CHECK_EQUAL(getpgid(b.m_pid), leader.m_pid);
+
+    std::vector<group_monitor::result> done;
+    group_monitor(leader).terminate(bp::posix::termination_policy(SIGTERM, 1000)(SIGKILL), done);
+
+    BOOST_REQUIRE_EQUAL(done.size(), 3u);
+    for(std::size_t i = 0; i < done.size(); ++i) BOOST_CHECK(done[i].m_status.signaled() && done[i].m_status.signal() == SIGTERM);
+    BOOST_CHECK(!group_monitor(leader).signal(0));
+}
+
+BOOST_AUTO_TEST_CASE(join_times_out)
+{
+    bp::child leader = sleeper();
+
+    std::vector<group_monitor::result> done;
+    BOOST_CHECK(!group_monitor(leader).join(done, 20));
+    BOOST_CHECK(done.empty());
+
+    BOOST_CHECK(group_monitor(leader).signal(SIGKILL));
+    group_monitor(leader).join(done);
+    BOOST_CHECK_EQUAL(done.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(new_session_leads_session_and_group)
+{
+    bp::monitor m(bp::make_child(bp::paths("/bin/sleep", "/"), bp::args("30"), bp::posix::new_session()));
+
+    BOOST_CHECK_EQUAL(getsid(m.m_id), m.m_id);
+    BOOST_CHECK_EQUAL(getpgid(m.m_id), m.m_id);
+    BOOST_CHECK(getsid(m.m_id) != getsid(0));
+
+    m.terminate();
+    m.join();
+}
+
+BOOST_AUTO_TEST_CASE(tree_of_hundred_in_one_call)
+{
+    const int n = 100;
+
+    BOOST_REQUIRE(group_monitor::adopt_orphans());
+
+    bp::file_descriptor_ray ray;
+    bp::child leader = bp::make_child(bp::paths("/bin/sh", "/"),
+                                      bp::args("-c")("i=0; while [ $i -lt 100 ]; do sleep 30 & i=$((i+1)); done; echo ready; wait"),
+                                      bp::posix::new_process_group(), bp::std_out_to(ray));
+    ray.m_sink.close();
+
+    bio::stream<bio::file_descriptor_source> is(ray.m_source);
+    std::string line;
+    std::getline(is, line);
+    BOOST_REQUIRE_EQUAL(line, "ready");
+
+    bc::steady_clock::time_point start = bc::steady_clock::now();
+    std::vector<group_monitor::result> done;
+    group_monitor(leader).terminate(bp::posix::termination_policy(SIGTERM, 2000)(SIGKILL), done);
+    bc::milliseconds took = bc::duration_cast<bc::milliseconds>(bc::steady_clock::now() - start);
+
+    BOOST_TEST_MESSAGE("ended " << n << " descendants in " << took << ", reaped " << done.size());
+    BOOST_CHECK_EQUAL(done.size(), std::size_t(n + 1)); // the shell and the sleeps it left to us
+    BOOST_CHECK(kill(-leader.m_pid, 0) == -1 && errno == ESRCH);
+}
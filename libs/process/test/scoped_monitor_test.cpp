@@ -0,0 +1,180 @@
+// Boost.Process library
+// Tests scoped_monitor's exit policies and the background reaper.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE ProcessLib
+
+// Linux requires dynamic linkage of Boost.Test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/process/process.hpp>
+#include <boost/chrono.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <stdexcept>
+#include <string>
+
+#include <errno.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace bp = boost::process;
+namespace bc = boost::chrono;
+
+namespace {
+
+    typedef bp::posix::scoped_monitor scoped_monitor;
+
+    bp::child sleeper(const char* seconds = "10")
+    {
+        return bp::make_child(bp::paths("/bin/sleep", "/"), bp::args(seconds));
+    }
+
+    /// A sleeper whose scoped_monitor released it before going out of scope.
+    bp::child released_sleeper()
+    {
+        scoped_monitor m(sleeper());
+        return m.release();
+    }
+
+    /// Reaped by someone: the pid is no child of ours any more.
+    bool reaped(pid_t pid)
+    {
+        int status;
+        return waitpid(pid, &status, WNOHANG) == -1 && errno == ECHILD;
+    }
+
+    bool reaper_idle(int timeout_ms)
+    {
+        for(int i = 0; i < timeout_ms && bp::posix::reaper::instance().pending(); ++i)
+        {
+            boost::this_thread::sleep_for(bc::milliseconds(1));
+        }
+        return bp::posix::reaper::instance().pending() == 0;
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(exception_does_not_leak_zombie)
+{
+    pid_t pid = -1;
+    try
+    {
+        scoped_monitor m(sleeper());
+        pid = m.m_id;
+
+        throw std::runtime_error("between make_child and join");
+    }
+    catch(const std::runtime_error&)
+    {
+    }
+
+    BOOST_REQUIRE(reaper_idle(6000));
+    BOOST_CHECK(reaped(pid));
+}
+
+BOOST_AUTO_TEST_CASE(destructor_does_not_block)
+{
+    const int n = 100;
+
+    bc::steady_clock::duration in_destructors(0);
+    for(int i = 0; i < n; ++i)
+    {
+        scoped_monitor* m = new scoped_monitor(sleeper(), scoped_monitor::terminate_detached, bp::posix::termination_policy(SIGKILL));
+
+        bc::steady_clock::time_point start = bc::steady_clock::now();
+        delete m;
+        in_destructors += bc::steady_clock::now() - start;
+    }
+    BOOST_TEST_MESSAGE(n << " destructors took " << bc::duration_cast<bc::microseconds>(in_destructors));
+
+    BOOST_CHECK(in_destructors < bc::milliseconds(100));
+    BOOST_CHECK(reaper_idle(5000));
+}
+
+BOOST_AUTO_TEST_CASE(join_on_exit)
+{
+    pid_t pid;
+    {
+        scoped_monitor m(bp::make_child(bp::paths("/bin/sh", "/"), bp::args("-c")("sleep 0.05")), scoped_monitor::join_on_exit);
+        pid = m.m_id;
+    }
+    BOOST_CHECK(reaped(pid));
+}
+
+BOOST_AUTO_TEST_CASE(terminate_on_exit)
+{
+    pid_t pid;
+    bc::steady_clock::time_point start = bc::steady_clock::now();
+    {
+        scoped_monitor m(sleeper(), scoped_monitor::terminate_on_exit, bp::posix::termination_policy(SIGTERM, 1000)(SIGKILL));
+        pid = m.m_id;
+    }
+    BOOST_CHECK(reaped(pid));
+    BOOST_CHECK(bc::steady_clock::now() - start < bc::milliseconds(1000));
+}
+
+BOOST_AUTO_TEST_CASE(detach_on_exit)
+{
+    pid_t pid;
+    {
+        scoped_monitor m(sleeper("0.1"), scoped_monitor::detach_on_exit);
+        pid = m.m_id;
+    }
+    BOOST_CHECK_EQUAL(kill(pid, 0), 0); // left running
+
+    BOOST_REQUIRE(reaper_idle(5000));
+    BOOST_CHECK(reaped(pid));
+}
+
+BOOST_AUTO_TEST_CASE(joined_or_released_child_left_alone)
+{
+    {
+        scoped_monitor m(bp::make_child(bp::paths("/bin/true", "/")));
+        BOOST_CHECK(m.join_for(bc::seconds(10)));
+    }
+    BOOST_CHECK_EQUAL(bp::posix::reaper::instance().pending(), 0u);
+
+    bp::child c = released_sleeper();
+    BOOST_CHECK_EQUAL(bp::posix::reaper::instance().pending(), 0u);
+    BOOST_CHECK_EQUAL(kill(c.m_pid, 0), 0);
+
+    bp::monitor(c).terminate(bp::posix::termination_policy(SIGKILL));
+}
+
+BOOST_AUTO_TEST_CASE(join_through_base_monitor_is_seen)
+{
+    {
+        scoped_monitor m(bp::make_child(bp::paths("/bin/true", "/")));
+        bp::posix::join<std::exception>(m); // the free join takes a monitor&
+    }
+    BOOST_CHECK_EQUAL(bp::posix::reaper::instance().pending(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(reaper_never_signals_a_pid_that_is_no_child)
+{
+    // a sleep orphaned by its shell stands in for a reaped child's recycled pid
+    bp::file_descriptor_ray out;
+    bp::monitor sh(bp::make_child(bp::paths("/bin/sh", "/"), bp::args("-c")("sleep 10 > /dev/null & echo $!"), bp::std_out_to(out)));
+    out.m_sink.close();
+
+    std::string text;
+    char buffer[64];
+    ssize_t n;
+    while((n = read(out.m_source.handle(), buffer, sizeof(buffer))) > 0) text.append(buffer, std::size_t(n));
+    BOOST_REQUIRE(sh.join().success());
+
+    const pid_t pid = boost::lexical_cast<pid_t>(text.substr(0, text.find('\n')));
+    BOOST_REQUIRE_EQUAL(kill(pid, 0), 0);
+
+    bp::posix::reaper::instance().add(pid, bp::posix::termination_policy(SIGKILL));
+    BOOST_CHECK(reaper_idle(5000));
+    BOOST_CHECK_EQUAL(kill(pid, 0), 0); // still running
+
+    kill(pid, SIGKILL);
+}
@@ -0,0 +1,98 @@
+// Boost.Process library
+// Tests launching through the executor core compiled into the library.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE ProcessLib
+
+// Linux requires dynamic linkage of Boost.Test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/launch_backend.hpp>
+#include <boost/process/posix/initializers/function.hpp>
+#include <boost/process/posix/initializers/process_group.hpp>
+
+#include <cerrno>
+#include <string>
+
+#include <unistd.h>
+
+#if !defined(BOOST_PROCESS_SEPARATE_COMPILATION) || defined(BOOST_PROCESS_HEADER_ONLY)
+#   error "separate_compilation_test is built with BOOST_PROCESS_SEPARATE_COMPILATION"
+#endif
+
+namespace bp = boost::process;
+
+typedef bp::posix::launch_backend launch_backend;
+
+namespace {
+
+    std::string read_all(bp::file_descriptor_ray& ray)
+    {
+        ray.m_sink.close();
+
+        std::string s;
+        char buffer[256];
+        ssize_t n;
+        while((n = read(ray.m_source.handle(), buffer, sizeof(buffer))) > 0) s.append(buffer, std::size_t(n));
+        return s;
+    }
+
+    int seven() { return 7; }
+
+}
+
+BOOST_AUTO_TEST_CASE( common_launch_runs )
+{
+    bp::file_descriptor_ray out;
+    bp::monitor m(bp::make_child(bp::paths("/bin/sh", "/"), bp::args("-c")("echo compiled"), bp::std_out_to(out)));
+
+    BOOST_CHECK_EQUAL(read_all(out), "compiled\n");
+    BOOST_CHECK(m.join().success());
+}
+
+BOOST_AUTO_TEST_CASE( other_launch_runs )
+{
+    bp::file_descriptor_ray err;
+    bp::child c = bp::make_child(bp::paths("/bin/sh", "/"), bp::args("-c")("echo group >&2; exit 4"), bp::std_err_to(err), bp::posix::new_process_group());
+
+    BOOST_CHECK_EQUAL(getpgid(c.handle()), c.handle());
+    BOOST_CHECK_EQUAL(read_all(err), "group\n");
+    BOOST_CHECK_EQUAL(bp::monitor(c).join().code(), 4);
+}
+
+BOOST_AUTO_TEST_CASE( failed_exec_is_reported )
+{
+    try
+    {
+        bp::make_child(bp::paths("/nonexistent/exe"), bp::throw_on_launch_error<>());
+        BOOST_ERROR("no launch_error thrown");
+    }
+    catch(const bp::posix::launch_error& ex)
+    {
+        BOOST_CHECK_EQUAL(ex.code().value(), ENOENT);
+        BOOST_CHECK_EQUAL(ex.initializer(), 0); // paths, changing to the missing directory
+    }
+
+    boost::system::error_code ec;
+    BOOST_CHECK(!bp::make_child(ec, bp::paths("/nonexistent/exe"), bp::args("x")));
+    BOOST_CHECK_EQUAL(ec.value(), ENOENT);
+}
+
+BOOST_AUTO_TEST_CASE( both_backends_run )
+{
+    launch_backend::set_policy(launch_backend::vfork_when_safe);
+    launch_backend::reset_counters();
+
+    BOOST_CHECK(bp::monitor(bp::make_child(bp::paths("/bin/true"))).join().success());
+    BOOST_CHECK_EQUAL(bp::monitor(bp::make_child(bp::posix::function(&seven))).join().code(), 7); // forked, copies memory
+
+    BOOST_CHECK_EQUAL(launch_backend::launches(launch_backend::vfork_backend), 1u);
+    BOOST_CHECK_EQUAL(launch_backend::launches(launch_backend::fork_backend ), 1u);
+
+    launch_backend::set_policy(launch_backend::automatic);
+}
@@ -0,0 +1,70 @@
+// Boost.Process library
+// Measures small message throughput from parent to child through a shm_ray
+// and through a pipe.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/shm_ray.hpp>
+#include <boost/chrono.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <unistd.h>
+
+namespace bp = boost::process;
+namespace bc = boost::chrono;
+
+namespace {
+
+    void report(const char* what, unsigned long n, bc::duration<double> elapsed)
+    {
+        std::cout << std::left  << std::setw(24) << what
+                  << std::right << std::setw(14) << std::fixed << std::setprecision(0) << (n / elapsed.count()) << " msgs/s" << std::endl;
+    }
+
+}
+
+int main(int argc, char *argv[])
+{
+    const unsigned long n = (argc > 1)? boost::lexical_cast<unsigned long>(argv[1]) : 10000000ul;
+    const char msg[16] = "0123456789abcde";
+
+    {
+        bp::posix::shm_ray ray;
+        bp::monitor m(bp::make_child(bp::paths("child_shm_echo"), bp::args("count"),
+                                     bp::environment(bp::clean_environment())(ray.environment_variable()), ray));
+
+        bc::steady_clock::time_point start = bc::steady_clock::now();
+        for(unsigned long i = 0; i < n; ++i) ray.m_sink.send(msg, sizeof(msg));
+        ray.m_sink.close();
+
+        std::vector<char> reply;
+        ray.m_source.receive(reply);
+        report("shm_ray, 16 byte msgs", *reinterpret_cast<unsigned long*>(&reply[0]), bc::steady_clock::now() - start);
+        m.join();
+    }
+    {
+        // one write per message, read by cat into /dev/null
+        bp::file_descriptor_ray ray;
+        bp::monitor m(bp::make_child(bp::paths("/bin/cat", "/"), bp::std_in_from(ray)));
+        ray.m_source.close();
+
+        const unsigned long pipe_n = n / 10;
+        bc::steady_clock::time_point start = bc::steady_clock::now();
+        for(unsigned long i = 0; i < pipe_n; ++i)
+        {
+            if(write(ray.m_sink.handle(), msg, sizeof(msg)) != sizeof(msg)) return 1;
+        }
+        ray.m_sink.close();
+        m.join();
+        report("pipe, 16 byte writes", pipe_n, bc::steady_clock::now() - start);
+    }
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+// Boost.Process library
+// Tests of the shared memory message rings between parent and child.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE ProcessLib
+
+// Linux requires dynamic linkage of Boost.Test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/shm_ray.hpp>
+#include <boost/filesystem.hpp>
+
+#include <string>
+#include <vector>
+
+namespace bp = boost::process;
+namespace fs = boost::filesystem;
+
+BOOST_AUTO_TEST_CASE(ring_wraps_around)
+{
+    bp::posix::shm_ray ray(4096);
+    bp::posix::shm_ring& r = ray.m_sink;
+
+    std::vector<char> msg;
+    for(int i = 0; i < 1000; ++i)
+    {
+        std::string s(i % 300, char('a' + i % 26));
+        BOOST_REQUIRE(r.try_send(s.data(), s.size()));
+        BOOST_REQUIRE(r.try_receive(msg));
+        BOOST_CHECK(std::string(msg.begin(), msg.end()) == s);
+    }
+    BOOST_CHECK(!r.try_receive(msg));
+}
+
+BOOST_AUTO_TEST_CASE(full_ring_refuses)
+{
+    bp::posix::shm_ray ray(4096);
+    char block[1000] = {0};
+
+    int sent = 0;
+    while(ray.m_sink.try_send(block, sizeof(block))) ++sent;
+
+    BOOST_CHECK_EQUAL(sent, 4);
+}
+
+BOOST_AUTO_TEST_CASE(send_times_out)
+{
+    bp::posix::shm_ray ray(4096);
+    char block[1000] = {0};
+
+    while(ray.m_sink.try_send(block, sizeof(block))) {}
+
+    BOOST_CHECK(!ray.m_sink.send(block, sizeof(block), 50));
+}
+
+BOOST_AUTO_TEST_CASE(child_exit_wakes_blocked_send_and_receive)
+{
+    bp::posix::shm_ray ray(4096);
+    bp::monitor m(bp::make_child(bp::paths("child_shm_echo"), bp::args("quit"),
+                                 bp::environment(bp::clean_environment())(ray.environment_variable()),
+                                 ray, bp::throw_on_launch_error<>()));
+
+    // the child never reads, its shm_ray stops receiving and closes its sink on exit
+    char block[1000] = {0};
+    while(ray.m_sink.send(block, sizeof(block))) {}
+
+    std::vector<char> msg;
+    BOOST_CHECK(!ray.m_source.receive(msg));
+    BOOST_CHECK(!ray.m_sink.send(block, sizeof(block))); // fails from then on
+    BOOST_CHECK_EQUAL(m.join(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(echo_through_child)
+{
+    fs::path child_process = "child_shm_echo";
+    BOOST_CHECK_EQUAL(true, fs::exists(child_process));
+
+    bp::posix::shm_ray ray(4096); // small, so both rings fill up and the sides block
+    bp::monitor m(bp::make_child(bp::paths(child_process), bp::args("echo"),
+                                 bp::environment(bp::clean_environment())(ray.environment_variable()),
+                                 ray, bp::throw_on_launch_error<>()));
+
+    const int n = 10000;
+    int received = 0;
+    std::vector<char> msg;
+    for(int i = 0; i < n; )
+    {
+        // never block on a full ring while the child may block on the other one
+        if(ray.m_sink.try_send(&i, sizeof(i))) ++i;
+
+        while(ray.m_source.try_receive(msg))
+        {
+            BOOST_REQUIRE_EQUAL(msg.size(), sizeof(int));
+            BOOST_CHECK_EQUAL(*reinterpret_cast<int*>(&msg[0]), received);
+            ++received;
+        }
+    }
+    ray.m_sink.close();
+    while(ray.m_source.receive(msg, 5000)) ++received;
+
+    BOOST_CHECK_EQUAL(received, n);
+    BOOST_CHECK_EQUAL(m.join(), 0);
+}
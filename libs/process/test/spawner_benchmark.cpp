@@ -0,0 +1,130 @@
+// Boost.Process library
+// Measures how long the launching thread is held up per launch, forking itself
+// or submitting to a spawner.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/spawner.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/mman.h>
+
+namespace bp = boost::process;
+namespace bc = boost::chrono;
+
+namespace {
+
+    typedef std::vector<double> samples_type; // microseconds
+
+    /// Wall clock and the launching thread's own CPU time, which differ where the thread
+    /// waits, e.g. for a CPU while the spawner forks on a single core machine.
+    struct clocks
+    {
+        bc::steady_clock::time_point m_wall;
+        bc::thread_clock::time_point m_cpu;
+
+        clocks() : m_wall(bc::steady_clock::now()), m_cpu(bc::thread_clock::now()) {}
+
+        void record(samples_type& wall, samples_type& cpu) const
+        {
+            wall.push_back(bc::duration<double, boost::micro>(bc::steady_clock::now() - m_wall).count());
+            cpu .push_back(bc::duration<double, boost::micro>(bc::thread_clock::now() - m_cpu ).count());
+        }
+    };
+
+    struct children
+    {
+        boost::mutex           m_mutex;
+        std::vector<bp::child> m_children;
+
+        void add(const bp::child& c, const std::exception*)
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_children.push_back(c);
+        }
+
+        void join_all()
+        {
+            for(std::size_t i = 0; i < m_children.size(); ++i) bp::monitor(m_children[i]).join();
+            m_children.clear();
+        }
+    };
+
+    void report(const std::string& name, samples_type s)
+    {
+        std::sort(s.begin(), s.end());
+
+        std::cout << std::left  << std::setw(28) << name << std::right << std::fixed << std::setprecision(1)
+                  << "  p50 " << std::setw(9) << s[s.size() / 2]
+                  << "  p99 " << std::setw(9) << s[s.size() * 99 / 100]
+                  << "  max " << std::setw(9) << s.back() << " us" << std::endl;
+    }
+
+    void direct(int n)
+    {
+        children c;
+        samples_type wall, cpu;
+        for(int i = 0; i < n; ++i)
+        {
+            clocks start;
+            c.add(bp::make_child(bp::paths("/bin/true", "/")), 0);
+            start.record(wall, cpu);
+
+            boost::this_thread::sleep(boost::posix_time::microseconds(500));
+        }
+        c.join_all();
+        report("make_child, wall", wall);
+        report("make_child, thread cpu", cpu);
+    }
+
+    void spawned(int n)
+    {
+        children c;
+        samples_type wall, cpu;
+        {
+            bp::posix::spawner sp;
+            for(int i = 0; i < n; ++i)
+            {
+                clocks start;
+                sp.submit(boost::bind(&children::add, &c, _1, _2), bp::paths("/bin/true", "/"));
+                start.record(wall, cpu);
+
+                boost::this_thread::sleep(boost::posix_time::microseconds(500));
+            }
+        }
+        c.join_all();
+        report("spawner submit, wall", wall);
+        report("spawner submit, thread cpu", cpu);
+    }
+
+}
+
+int main(int argc, char *argv[])
+{
+    const int         n  = (argc > 1)? boost::lexical_cast<int>(argv[1]) : 1000;
+    const std::size_t mb = (argc > 2)? boost::lexical_cast<std::size_t>(argv[2]) : 512;
+
+    // resident memory makes each fork copy page tables for longer
+    void* resident = mmap(0, mb << 20, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    if(resident != MAP_FAILED) std::memset(resident, 1, mb << 20);
+
+    std::cout << n << " launches of /bin/true with " << mb << " MB resident, time in the launching thread" << std::endl;
+
+    direct(n);
+    spawned(n);
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Boost.Process library
+// Tests launching children on a spawner thread.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE ProcessLib
+
+// Linux requires dynamic linkage of Boost.Test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/spawner.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <set>
+#include <vector>
+
+#include <pthread.h>
+
+namespace bp = boost::process;
+
+namespace {
+
+    /// Records every callback, under a lock since submitters check it too.
+    struct recorder
+    {
+        boost::mutex           m_mutex;
+        std::vector<int>       m_order;
+        std::vector<bp::child> m_children;
+        std::vector<bool>      m_errors;
+        std::vector<pthread_t> m_threads;
+
+        void done(int index, const bp::child& c, const std::exception* error)
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_order.push_back(index);
+            m_children.push_back(c);
+            m_errors.push_back(error != 0);
+            m_threads.push_back(pthread_self());
+        }
+
+        bp::posix::spawner::callback_type callback(int index) { return boost::bind(&recorder::done, this, index, _1, _2); }
+    };
+
+    void submit_many(bp::posix::spawner& s, recorder& r, int first, int n)
+    {
+        for(int i = first; i < first + n; ++i) s.submit(r.callback(i), bp::paths("/bin/true", "/"));
+    }
+
+    bp::child launch_false() { return bp::make_child(bp::paths("/bin/false", "/")); }
+
+}
+
+BOOST_AUTO_TEST_CASE(launches_in_order_off_the_submitting_thread)
+{
+    recorder r;
+    {
+        bp::posix::spawner s;
+        submit_many(s, r, 0, 20);
+    } // runs what was submitted
+
+    BOOST_REQUIRE_EQUAL(r.m_order.size(), 20u);
+    for(std::size_t i = 0; i < r.m_order.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(r.m_order[i], int(i));
+        BOOST_CHECK(!r.m_errors[i]);
+        BOOST_CHECK(!pthread_equal(r.m_threads[i], pthread_self()));
+        BOOST_CHECK_EQUAL(bp::monitor(r.m_children[i]).join(), 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(failures_reach_the_callback)
+{
+    recorder r;
+    {
+        bp::posix::spawner s;
+        s.submit(r.callback(0), bp::paths("/nonexistent/exe"), bp::throw_on_launch_error<>());
+        s.submit(r.callback(1), bp::paths("/bin/true", "/"));
+    }
+
+    BOOST_REQUIRE_EQUAL(r.m_order.size(), 2u);
+    BOOST_CHECK(r.m_errors[0]);
+    BOOST_CHECK(r.m_children[0] == bp::child());
+
+    // the thread goes on with the next launch
+    BOOST_CHECK(!r.m_errors[1]);
+    BOOST_CHECK_EQUAL(bp::monitor(r.m_children[1]).join(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(many_submitting_threads)
+{
+    recorder r;
+    {
+        bp::posix::spawner s;
+
+        boost::thread_group group;
+        for(int t = 0; t < 4; ++t) group.create_thread(boost::bind(&submit_many, boost::ref(s), boost::ref(r), t * 50, 50));
+        group.join_all();
+    }
+
+    BOOST_REQUIRE_EQUAL(r.m_order.size(), 200u);
+    BOOST_CHECK_EQUAL(std::set<int>(r.m_order.begin(), r.m_order.end()).size(), 200u);
+
+    std::set<pid_t> pids;
+    for(std::size_t i = 0; i < r.m_children.size(); ++i)
+    {
+        pids.insert(r.m_children[i].handle());
+        BOOST_CHECK_EQUAL(bp::monitor(r.m_children[i]).join(), 0);
+    }
+    BOOST_CHECK_EQUAL(pids.size(), 200u);
+}
+
+BOOST_AUTO_TEST_CASE(any_launch_callable)
+{
+    recorder r;
+    bp::posix::spawner s;
+    s.submit_launch(&launch_false, r.callback(0));
+
+    while(s.pending()) boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+
+    boost::mutex::scoped_lock lock(r.m_mutex);
+    BOOST_REQUIRE_EQUAL(r.m_children.size(), 1u);
+    BOOST_CHECK_EQUAL(bp::monitor(r.m_children[0]).join().code(), 1);
+}
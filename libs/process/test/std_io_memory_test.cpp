@@ -0,0 +1,63 @@
+// Boost.Process library
+// Tests feeding and capturing the std streams of children in memory.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE ProcessLib
+
+// Linux requires dynamic linkage of Boost.Test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/initializers/std_io_memory.hpp>
+
+#include <string>
+
+namespace bp = boost::process;
+
+BOOST_AUTO_TEST_CASE(cat_memory_to_memory)
+{
+    std::string input;
+    for (int i = 0; i < 100000; ++i) input += "line of input\n"; // well beyond a pipe buffer
+
+    bp::posix::std_in_from_memory in(input);
+    bp::posix::std_out_to_memory  out;
+
+    bp::monitor(bp::make_child(bp::paths("/bin/cat", "/"), in, out, bp::throw_on_launch_error<>())).join();
+
+    BOOST_CHECK_EQUAL(out.size(), input.size());
+    BOOST_CHECK(out.str() == input);
+}
+
+BOOST_AUTO_TEST_CASE(input_is_sealed)
+{
+    bp::posix::std_in_from_memory in(std::string("sealed"));
+
+    BOOST_CHECK_EQUAL(::write(in.m_file->handle(), "x", 1), -1);
+    BOOST_CHECK_EQUAL(errno, EPERM);
+}
+
+BOOST_AUTO_TEST_CASE(input_reused_from_the_start)
+{
+    bp::posix::std_in_from_memory in(std::string("again\n"));
+    bp::posix::std_out_to_memory  out;
+
+    for (int i = 0; i < 2; ++i)
+    {
+        out.clear();
+        bp::monitor(bp::make_child(bp::paths("/bin/cat", "/"), in, out)).join();
+        BOOST_CHECK_EQUAL(out.str(), "again\n");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(capture_std_err)
+{
+    bp::posix::std_err_to_memory err;
+
+    bp::monitor(bp::make_child(bp::paths("/bin/cat", "/"), bp::args("/does/not/exist"), err)).join();
+
+    BOOST_CHECK(err.str().find("/does/not/exist") != std::string::npos);
+}
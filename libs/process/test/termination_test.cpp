@@ -0,0 +1,112 @@
+// Boost.Process library
+// Tests ending children with termination policies.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE ProcessLib
+
+// Linux requires dynamic linkage of Boost.Test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/initializers/process_group.hpp>
+#include <boost/process/posix/monitor_group.hpp>
+#include <boost/chrono.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace bp  = boost::process;
+namespace bc  = boost::chrono;
+namespace bio = boost::iostreams;
+
+namespace {
+
+    bp::child shell(const std::string& script)
+    {
+        return bp::make_child(bp::paths("/bin/sh", "/"), bp::args("-c")(script));
+    }
+
+    /// Gone or a zombie, in a container nobody may reap orphans.
+    bool dead(pid_t pid)
+    {
+        std::ifstream stat(("/proc/" + boost::lexical_cast<std::string>(pid) + "/stat").c_str());
+        std::string id, name, state;
+        return !(stat >> id >> name >> state) || state == "Z";
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(sigterm_is_enough)
+{
+    bp::monitor m(shell("trap 'exit 3' TERM; sleep 10 & wait"));
+    boost::this_thread::sleep_for(bc::milliseconds(100)); // let the shell set its trap
+
+    int status = m.terminate(bp::posix::termination_policy());
+
+    BOOST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 3);
+}
+
+BOOST_AUTO_TEST_CASE(sigkill_after_grace_period)
+{
+    bp::monitor m(shell("trap '' TERM; while :; do sleep 0.01; done"));
+    boost::this_thread::sleep_for(bc::milliseconds(100));
+
+    bc::steady_clock::time_point start = bc::steady_clock::now();
+    int status = m.terminate(bp::posix::termination_policy(SIGTERM, 200)(SIGKILL));
+    bc::milliseconds took = bc::duration_cast<bc::milliseconds>(bc::steady_clock::now() - start);
+
+    BOOST_CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL);
+    BOOST_CHECK(took >= bc::milliseconds(200));
+    BOOST_CHECK(took <  bc::milliseconds(2000));
+}
+
+BOOST_AUTO_TEST_CASE(whole_process_group)
+{
+    bp::file_descriptor_ray ray;
+    bp::monitor m(bp::make_child(bp::paths("/bin/sh", "/"), bp::args("-c")("sleep 10 & echo $!; wait"),
+                                 bp::posix::new_process_group(), bp::std_out_to(ray)));
+    ray.m_sink.close();
+
+    BOOST_CHECK_EQUAL(getpgid(m.m_id), m.m_id);
+
+    bio::stream<bio::file_descriptor_source> is(ray.m_source);
+    pid_t grandchild = 0;
+    is >> grandchild;
+    BOOST_REQUIRE(grandchild > 0);
+
+    m.terminate(bp::posix::termination_policy(SIGTERM, 1000)(SIGKILL).to_process_group());
+
+    bool gone = false;
+    for (int i = 0; i < 100 && !gone; ++i)
+    {
+        gone = dead(grandchild);
+        if (!gone) boost::this_thread::sleep_for(bc::milliseconds(10));
+    }
+    BOOST_CHECK(gone);
+}
+
+BOOST_AUTO_TEST_CASE(group_of_many)
+{
+    const std::size_t n = 500;
+
+    bp::posix::monitor_group g;
+    for (std::size_t i = 0; i < n; ++i) g.add(bp::make_child(bp::paths("/bin/sleep", "/"), bp::args("10")));
+
+    bc::steady_clock::time_point start = bc::steady_clock::now();
+    std::vector<bp::posix::monitor_group::result> done;
+    BOOST_CHECK_EQUAL(g.terminate(bp::posix::termination_policy(), done), bp::posix::monitor_group::completed);
+    bc::milliseconds took = bc::duration_cast<bc::milliseconds>(bc::steady_clock::now() - start);
+
+    BOOST_REQUIRE_EQUAL(done.size(), n);
+    for (std::size_t i = 0; i < n; ++i) BOOST_CHECK(WIFSIGNALED(done[i].m_status) && WTERMSIG(done[i].m_status) == SIGTERM);
+    BOOST_TEST_MESSAGE("terminated " << n << " children in " << took);
+    BOOST_CHECK(took < bc::milliseconds(5000)); // well within the first grace period
+}
@@ -0,0 +1,106 @@
+// Boost.Process library
+// Measures how fast workers are ready when forked from a pre-initialized
+// template, against launching each one fresh.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/worker_template.hpp>
+#include <boost/chrono.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace bp = boost::process;
+namespace bc = boost::chrono;
+namespace fs = boost::filesystem;
+
+namespace {
+
+    const fs::path child_worker("./child_worker");
+
+    void wait_ready(int fd)
+    {
+        char c;
+        while(read(fd, &c, 1) == 1 && c != '\n') {}
+    }
+
+    void report(const std::string& name, int n, bc::duration<double> elapsed)
+    {
+        std::cout << std::left  << std::setw(44) << name
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(1) << (elapsed.count() * 1e6 / n) << " us/worker ready" << std::endl;
+    }
+
+    /// Launches n workers one after another, each until it is ready.
+    void fresh(int n, const std::string& init_ms, const std::string& model_mb)
+    {
+        bc::duration<double> elapsed(0);
+        for(int i = 0; i < n; ++i)
+        {
+            bc::steady_clock::time_point start = bc::steady_clock::now();
+
+            bp::file_descriptor_ray in, out;
+            bp::monitor m(bp::make_child(bp::paths(child_worker), bp::args(init_ms)(model_mb), bp::std_in_from(in), bp::std_out_to(out)));
+            out.m_sink.close();
+            wait_ready(out.m_source.handle());
+
+            elapsed += bc::steady_clock::now() - start;
+
+            in.m_sink.close();
+            m.join();
+        }
+        report("fresh launch", n, elapsed);
+    }
+
+    /// Asks the template for batch copies at a time, n in total.
+    void from_template(bp::posix::worker_template& t, int n, int batch)
+    {
+        bc::duration<double> elapsed(0);
+        for(int i = 0; i < n; i += batch)
+        {
+            bc::steady_clock::time_point start = bc::steady_clock::now();
+
+            std::vector<bp::posix::worker_copy> copies = t.fork_copies(batch);
+            for(std::size_t k = 0; k < copies.size(); ++k) wait_ready(copies[k].m_std_out.handle());
+
+            elapsed += bc::steady_clock::now() - start;
+
+            for(std::size_t k = 0; k < copies.size(); ++k)
+            {
+                copies[k].m_std_in.close();
+                bp::monitor(copies[k].m_child).join();
+            }
+        }
+        report("from template, " + boost::lexical_cast<std::string>(batch) + " per request", n, elapsed);
+    }
+
+}
+
+int main(int argc, char *argv[])
+{
+    const std::string init_ms  = (argc > 1)? argv[1] : "800";
+    const std::string model_mb = (argc > 2)? argv[2] : "256";
+    const int         n        = (argc > 3)? boost::lexical_cast<int>(argv[3]) : 200;
+
+    std::cout << "workers loading for " << init_ms << " ms and " << model_mb << " MB" << std::endl;
+
+    fresh(3, init_ms, model_mb);
+
+    bp::posix::worker_template t;
+    bp::monitor tm(bp::make_child(bp::paths(child_worker), bp::args(init_ms)(model_mb), t.control()));
+    t.fork_copies(1); // waits until the template is initialized
+
+    from_template(t, n, 1);
+    from_template(t, n, 10);
+    from_template(t, n, 100);
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+// Boost.Process library
+// Tests forking ready workers from a pre-initialized template.
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#define BOOST_TEST_MODULE ProcessLib
+
+// Linux requires dynamic linkage of Boost.Test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/process/process.hpp>
+#include <boost/process/posix/worker_template.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace bp = boost::process;
+namespace fs = boost::filesystem;
+
+namespace {
+
+    const fs::path child_worker("./child_worker");
+
+    std::string read_line(int fd)
+    {
+        std::string line;
+        char c;
+        while(read(fd, &c, 1) == 1 && c != '\n') line += c;
+        return line;
+    }
+
+    std::string ready_line() { return "ready " + boost::lexical_cast<std::string>(getpid()) + " m"; }
+
+}
+
+BOOST_AUTO_TEST_CASE(copies_are_ready_children)
+{
+    bp::posix::worker_template t;
+    bp::monitor tm(bp::make_child(bp::paths(child_worker), bp::args("50")("16"), t.control()));
+
+    std::vector<bp::posix::worker_copy> copies = t.fork_copies(3);
+    BOOST_REQUIRE_EQUAL(copies.size(), 3u);
+
+    for(std::size_t i = 0; i < copies.size(); ++i)
+    {
+        bp::posix::worker_copy& c = copies[i];
+
+        // a child of this process, with the template's memory
+        BOOST_CHECK_EQUAL(read_line(c.m_std_out.handle()), ready_line());
+
+        BOOST_CHECK_EQUAL(write(c.m_std_in.handle(), "ping\n", 5), 5);
+        BOOST_CHECK_EQUAL(read_line(c.m_std_out.handle()), "ping");
+
+        c.m_std_in.close();
+        BOOST_CHECK_EQUAL(bp::monitor(c.m_child).join(), 0);
+    }
+
+    // more on a later request, stderr stays the template's
+    std::vector<bp::posix::worker_copy> more = t.fork_copies(2, bp::posix::worker_template::pipe_std_in | bp::posix::worker_template::pipe_std_out);
+    BOOST_REQUIRE_EQUAL(more.size(), 2u);
+    for(std::size_t i = 0; i < more.size(); ++i)
+    {
+        BOOST_CHECK(!more[i].m_std_err.is_open());
+        BOOST_CHECK_EQUAL(read_line(more[i].m_std_out.handle()), ready_line());
+        more[i].m_std_in.close();
+        BOOST_CHECK_EQUAL(bp::monitor(more[i].m_child).join(), 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(template_ends_with_the_worker_template)
+{
+    pid_t tc = -1;
+    {
+        bp::posix::worker_template t;
+        tc = bp::make_child(bp::paths(child_worker), t.control()).handle();
+    }
+    BOOST_CHECK_EQUAL(bp::monitor(bp::child(tc)).join(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(template_gone_throws)
+{
+    bp::posix::worker_template t;
+    bp::monitor tm(bp::make_child(bp::paths("/bin/true", "/"), t.control()));
+    tm.join();
+
+    BOOST_CHECK_THROW(t.fork_copies(1), boost::system::system_error);
+}
+
+BOOST_AUTO_TEST_CASE(plain_launch_is_a_worker)
+{
+    bp::file_descriptor_ray in, out;
+    bp::monitor m(bp::make_child(bp::paths(child_worker), bp::std_in_from(in), bp::std_out_to(out)));
+    in.m_source.close();
+    out.m_sink.close();
+
+    BOOST_CHECK_EQUAL(read_line(out.m_source.handle()), ready_line());
+    in.m_sink.close();
+    BOOST_CHECK_EQUAL(m.join(), 0);
+}